@@ -0,0 +1,1066 @@
+#ifndef BASICWORKQUEUE_H_
+#define BASICWORKQUEUE_H_
+
+#include "lthread.h"
+#include "task.h"
+#include "timer.h"
+#include "queuefrontend.h"
+#include "stats.h"
+#include "trace.h"
+#include "src/util/cacheline.hpp"
+#include "src/util/wsdeque.hpp"
+#include "src/util/mpmcqueue.hpp"
+#include "src/util/spscqueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+namespace lmc {
+
+/**
+ * OverflowPolicy - 全局队列达到容量上限（见 WorkQueueBase::setCapacity）时的处理策略
+ * - Block: 提交者阻塞，直到后台线程取走任务腾出空间（天然的背压）
+ * - Reject: 直接丢弃新任务，对应的 future 得到 broken_promise
+ * - DropOldest: 丢弃最早入队的任务（优先从 Low 通道丢弃），为新任务腾出空间；
+ *   SpscRing 的提交者不能从队列中取出任务，此时按 Reject 处理
+ * - CallerRuns: 在提交线程中直接执行新任务，提交者因此被减速
+ */
+enum class OverflowPolicy: unsigned char {
+    Block,
+    Reject,
+    DropOldest,
+    CallerRuns,
+};
+
+/**
+ * ShutdownMode - shutdown() 对尚未执行的任务的处理方式
+ * - Drain: 所有后台线程并行执行完已入队的任务（包括它们执行期间提交的子任务）后再退出
+ * - Cancel: 正在执行的任务执行完毕后立即退出，尚未开始的任务被丢弃，对应的 future 得到 broken_promise
+ */
+enum class ShutdownMode: unsigned char {
+    Drain,
+    Cancel,
+};
+
+/**
+ * 锁策略（BasicWorkQueue 的 LockPolicy 参数）：任何提供 lock()/unlock() 的类型，
+ * 例如 std::mutex、SpinMutex、TicketMutex、McsMutex。
+ *
+ * NullMutex - 不做任何互斥，只能与自身线程安全的队列策略（SpscRing、RingQueue）搭配
+ */
+struct NullMutex {
+    void lock() {}
+    void unlock() {}
+};
+
+/**
+ * 队列策略（BasicWorkQueue 的 QueuePolicy 参数）
+ * - LinkedQueue: 无界队列（std::queue，节点来自内存池），由 LockPolicy 保护
+ * - RingQueue: 预分配的有界无锁环形队列（MpmcQueue），忽略 LockPolicy；队列满时提交者让出 CPU 并重试
+ * - SpscRing: 预分配的有界单生产者单消费者无等待环形队列（SpscQueue），忽略 LockPolicy。
+ *   只允许一个外部线程提交，BasicWorkQueue 固定只有 1 个后台线程；后台线程自身提交的任务
+ *   （包括非 Normal 优先级与到期的定时器）全部进入其本地双端队列，不会成为全局队列的第二个生产者
+ */
+struct LinkedQueue {};
+
+struct RingQueue {
+    static constexpr size_t Capacity = 4096;
+};
+
+struct SpscRing {
+    static constexpr size_t Capacity = 4096;
+};
+
+static constexpr size_t LaneCount = 3; // 每个 Priority 一个全局通道
+
+/**
+ * LaneStorage - 按优先级分通道的全局队列存储
+ *
+ * - tryPush(): 入队，成功时消耗 task（环形队列满时返回 false，task 保持不变）
+ * - pushBatch(): 把一批任务放入同一个通道（LinkedQueue 只加锁一次）
+ * - take(): 取出最早入队的任务
+ * - clear(): 丢弃所有任务
+ * - empty() / count(): 所有通道是否为空 / 任务总数（任意线程均可调用，并发情况下为近似值）
+ * - contentions(): 加锁时锁已被占用的次数（仅在定义 LMC_ENABLE_STATS 时记录）
+ * 加锁的与多消费者的通道带一个近似任务数，空通道无需加锁即可跳过；计数在入队之后增加，
+ * 消费者看到计数时任务一定已可取出，计数滞后的情况由随后的唤醒兜底。
+ *
+ * SingleConsumer / SingleProducer 表示全局队列是否只允许一个消费者 / 生产者。
+ */
+template <typename LockPolicy, typename QueuePolicy>
+class LaneStorage;
+
+template <typename LockPolicy>
+class LaneStorage<LockPolicy, LinkedQueue> {
+    static_assert(!is_same<LockPolicy, NullMutex>::value,
+                  "LinkedQueue 需要真正的锁：无锁的单生产者场景请使用 SpscRing");
+
+public:
+    static constexpr bool SingleConsumer = false;
+    static constexpr bool SingleProducer = false;
+
+    LaneStorage() {
+        for (auto &s : size)
+            s.value.store(0, memory_order_relaxed);
+    }
+
+    bool tryPush(size_t lane, Task &task) {
+        acquire();
+        queues[lane].emplace(move(task));
+        lock.unlock();
+        size[lane].value.fetch_add(1, memory_order_release);
+        return true;
+    }
+
+    void pushBatch(size_t lane, vector<Task> &tasks) {
+        acquire();
+        for (auto &t : tasks)
+            queues[lane].emplace(move(t));
+        lock.unlock();
+        size[lane].value.fetch_add(static_cast<ptrdiff_t>(tasks.size()), memory_order_release);
+    }
+
+    bool take(size_t lane, Task &task) {
+        if (size[lane].value.load(memory_order_acquire) <= 0)
+            return false;
+
+        bool ok = false;
+        acquire();
+        if (!queues[lane].empty()) {
+            task = move(queues[lane].front());
+            queues[lane].pop();
+            ok = true;
+        }
+        lock.unlock();
+
+        if (ok)
+            size[lane].value.fetch_sub(1, memory_order_relaxed);
+        return ok;
+    }
+
+    bool empty() const {
+        for (auto &s : size)
+            if (s.value.load(memory_order_acquire) > 0)
+                return false;
+        return true;
+    }
+
+    size_t count() const {
+        ptrdiff_t n = 0;
+        for (auto &s : size)
+            n += s.value.load(memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    uint64_t contentions() const {
+#ifdef LMC_ENABLE_STATS
+        return contended.load(memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * 任务在锁外销毁：被丢弃任务的析构可能再次访问队列（恢复协程、报告 broken_promise 的续延等）
+     */
+    void clear() {
+        queue<Task, deque<Task, PoolAllocator<Task>>> dropped[LaneCount];
+        acquire();
+        for (size_t i = 0; i < LaneCount; ++i)
+            swap(dropped[i], queues[i]);
+        lock.unlock();
+    }
+
+private:
+    void acquire() {
+#if defined(LMC_ENABLE_STATS) || defined(LMC_ENABLE_TRACE)
+        if (lock.try_lock())
+            return;
+#ifdef LMC_ENABLE_STATS
+        contended.fetch_add(1, memory_order_relaxed);
+#endif
+#ifdef LMC_ENABLE_TRACE
+        if (trace::active()) {
+            int64_t begin = trace::now();
+            lock.lock();
+            trace::record(trace::Event::LockWait, begin, trace::now() - begin);
+            return;
+        }
+#endif
+#endif
+        lock.lock();
+    }
+
+    // 锁字与被保护的队列分属不同缓存行：自旋等待者反复写锁字时不会使持锁者正在修改的队列失效
+    alignas(CacheLineSize) LockPolicy lock;
+    alignas(CacheLineSize) queue<Task, deque<Task, PoolAllocator<Task>>> queues[LaneCount];
+    CacheAligned<atomic<ptrdiff_t>> size[LaneCount];
+#ifdef LMC_ENABLE_STATS
+    atomic<uint64_t> contended{0};         // 只在争用时写入
+#endif
+};
+
+template <typename LockPolicy>
+class LaneStorage<LockPolicy, RingQueue> {
+public:
+    static constexpr bool SingleConsumer = false;
+    static constexpr bool SingleProducer = false;
+
+    LaneStorage()
+        : rings{MpmcQueue<Task>(RingQueue::Capacity), MpmcQueue<Task>(RingQueue::Capacity),
+                MpmcQueue<Task>(RingQueue::Capacity)} {
+        for (auto &s : size)
+            s.value.store(0, memory_order_relaxed);
+    }
+
+    bool tryPush(size_t lane, Task &task) {
+        if (!rings[lane].push(move(task)))
+            return false;
+        size[lane].value.fetch_add(1, memory_order_release);
+        return true;
+    }
+
+    bool take(size_t lane, Task &task) {
+        if (size[lane].value.load(memory_order_acquire) <= 0)
+            return false;
+        if (!rings[lane].pop(task))
+            return false;
+        size[lane].value.fetch_sub(1, memory_order_relaxed);
+        return true;
+    }
+
+    bool empty() const {
+        for (auto &s : size)
+            if (s.value.load(memory_order_acquire) > 0)
+                return false;
+        return true;
+    }
+
+    size_t count() const {
+        ptrdiff_t n = 0;
+        for (auto &s : size)
+            n += s.value.load(memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    uint64_t contentions() const {
+        return 0;
+    }
+
+    void clear() {
+        Task pending;
+        for (auto &r : rings)
+            while (r.pop(pending))
+                pending = nullptr;
+    }
+
+private:
+    MpmcQueue<Task> rings[LaneCount];
+    CacheAligned<atomic<ptrdiff_t>> size[LaneCount];
+};
+
+/**
+ * 无等待的 SPSC 通道：队列自身的位置即可判断空/满，不再维护共享的任务计数，
+ * 提交者与后台线程之间没有任何读-改-写原子操作
+ */
+template <typename LockPolicy>
+class LaneStorage<LockPolicy, SpscRing> {
+public:
+    static constexpr bool SingleConsumer = true;
+    static constexpr bool SingleProducer = true;
+
+    LaneStorage()
+        : rings{SpscQueue<Task>(SpscRing::Capacity), SpscQueue<Task>(SpscRing::Capacity),
+                SpscQueue<Task>(SpscRing::Capacity)} {}
+
+    bool tryPush(size_t lane, Task &task) {
+        return rings[lane].push(move(task));
+    }
+
+    bool take(size_t lane, Task &task) {
+        return rings[lane].pop(task);
+    }
+
+    bool empty() const {
+        for (auto &r : rings)
+            if (!r.empty())
+                return false;
+        return true;
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        for (auto &r : rings)
+            n += r.size();
+        return n;
+    }
+
+    uint64_t contentions() const {
+        return 0;
+    }
+
+    /**
+     * 只能在没有消费者时调用（后台线程已退出）
+     */
+    void clear() {
+        Task pending;
+        for (auto &r : rings)
+            while (r.pop(pending))
+                pending = nullptr;
+    }
+
+private:
+    SpscQueue<Task> rings[LaneCount];
+};
+
+/**
+ * 当前线程正在通过 runPendingTask() 帮忙执行其任务的队列（嵌套帮忙执行时为最内层），否则为空
+ */
+inline thread_local const void *tlsHelpingQueue = nullptr;
+
+/**
+ * WorkQueueBase - 与锁策略、队列策略无关的工作队列公共部分（非模板，实现位于 workqueue.cpp）
+ *
+ * 包括：每个后台线程的工作窃取双端队列、定时器服务、容量上限与背压的慢路径、异常处理。
+ * 全局队列与调度顺序由派生类 BasicWorkQueue 按策略实现。
+ */
+class WorkQueueBase : public Thread {
+public:
+    /**
+     * 设置全局队列的容量上限与溢出策略，capacity 为 0 表示不限制（默认）
+     *
+     * - 容量统计所有优先级通道中尚未被取走的任务；应在提交任何任务之前设置
+     * - 只约束外部线程的提交：后台线程（任务内部）提交的任务不会阻塞或被丢弃，
+     *   以免所有后台线程都在等待空间而死锁
+     * - 被 Reject/DropOldest 丢弃的任务不会执行，其 future 得到 broken_promise，丢弃总数见 droppedTasks()
+     * - RingQueue 的环形队列本身容量固定，capacity 大于该容量时以环形队列为准（满时让出 CPU 重试）
+     */
+    void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+
+    /**
+     * 因溢出策略被丢弃的任务总数
+     */
+    size_t droppedTasks() const;
+
+    /**
+     * 设置 post() 提交的任务抛出异常时的处理函数（在执行该任务的后台线程中调用）
+     * 传入空函数恢复默认行为：将异常信息输出到 std::cerr。处理函数本身不应再抛出异常。
+     */
+    void setExceptionHandler(function<void(exception_ptr)> handler);
+
+    using Mode = ShutdownMode;
+
+    /**
+     * 是否已开始关闭（见 BasicWorkQueue::shutdown）
+     */
+    bool isShutdown() const {
+        return closed.load(memory_order_acquire);
+    }
+
+protected:
+    explicit WorkQueueBase(const ElasticPolicy &policy);
+    ~WorkQueueBase();
+
+    using LocalDeque = WorkStealingDeque<Task *>;
+
+    /**
+     * 放入本线程（后台线程 idx）的本地双端队列；本地队列只由拥有者线程 push，无需加锁
+     */
+    void pushLocal(size_t idx, Task &&task) {
+        deques[idx]->push(newNode(move(task)));
+    }
+
+    /**
+     * 从本线程的本地队列弹出（LIFO，缓存友好）
+     */
+    bool popLocal(size_t idx, Task &task) {
+        Task *local = nullptr;
+        if (!deques[idx]->pop(local))
+            return false;
+        task = move(*local);
+        deleteNode(local);
+        return true;
+    }
+
+    /**
+     * 从其他线程的本地队列窃取（从相邻线程开始轮询，分散竞争）；idx 为 npos 时从 0 号开始
+     * 后台线程先轮询同一 NUMA 节点（workerNode()）的线程，再轮询其他节点，减少跨节点访问任务数据
+     */
+    bool steal(size_t idx, Task &task);
+
+    /**
+     * 关闭后拒绝外部线程的提交：后台线程（以及正在帮忙执行本队列任务的线程）在排空期间提交的子任务
+     * 属于待排空的工作，照常接受
+     */
+    bool rejectExternal() const {
+        return closed.load(memory_order_acquire) && workerIndex() == npos && tlsHelpingQueue != this;
+    }
+
+    /**
+     * 所有本地队列是否为空（近似值）
+     */
+    bool localEmpty() const;
+
+    /**
+     * 所有本地双端队列中的任务数（近似）
+     */
+    size_t localCount() const;
+
+    /**
+     * 丢弃所有本地队列中的任务（只在后台线程退出后调用）
+     */
+    void discardLocal();
+
+    /**
+     * 唤醒所有阻塞等待空间的提交者（关闭时调用，使其放弃提交）
+     */
+    void wakeBlocked();
+
+    /**
+     * 本地双端队列的节点（堆上的 Task）从内存池分配：由提交线程分配、往往由窃取线程释放，
+     * 池的线程缓存按批回收，避免每个子任务都经过全局 malloc
+     */
+    static Task *newNode(Task &&task) {
+        PoolAllocator<Task> alloc;
+        return new (alloc.allocate(1)) Task(move(task));
+    }
+
+    static void deleteNode(Task *node) {
+        node->~Task();
+        PoolAllocator<Task>().deallocate(node, 1);
+    }
+
+    /**
+     * 统计与跟踪：记录入队时刻（都未定义时为空操作，只开启跟踪时仅在记录期间读取时钟）
+     */
+    static void markEnqueued(Task &task) {
+#if defined(LMC_ENABLE_STATS)
+        task.setEnqueueTime(chrono::steady_clock::now().time_since_epoch().count());
+#elif defined(LMC_ENABLE_TRACE)
+        if (trace::active())
+            task.setEnqueueTime(trace::now());
+#else
+        (void)task;
+#endif
+    }
+
+    /**
+     * 填充与全局队列无关的统计：各后台线程的计数、直方图与本地队列深度
+     */
+    void collectStats(WorkQueueStats &out) const;
+
+    /**
+     * 尝试占用一个容量名额（CAS，名额数严格不超过上限），未设置容量上限时总是成功且不计数
+     */
+    bool tryReserveSlot() {
+        size_t n = queued.load();
+        while (n < maxQueued) {
+            if (queued.compare_exchange_weak(n, n + 1))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Block 策略：阻塞直到有容量名额可能空出
+     */
+    void waitForSpace();
+
+    /**
+     * 释放一个容量名额并唤醒等待空间的提交者
+     */
+    void releaseSlot();
+
+    /**
+     * 执行一个任务，逃逸的异常交给异常处理函数
+     */
+    void execute(Task &task);
+
+    /**
+     * 将任务中逃逸的异常交给异常处理函数
+     */
+    void handleException(exception_ptr e);
+
+    /**
+     * 最近的定时器到期时刻：后台线程阻塞前查询，保证没有其他任务时定时器也能按时执行
+     */
+    chrono::steady_clock::time_point nextWakeup() override;
+
+    // 构造/初始设置之后只读的配置：每次提交与取任务都会读取，不与下面被频繁写入的状态共享缓存行
+    size_t maxQueued;                      // 全局队列容量上限，0 表示不限制
+    OverflowPolicy overflow;               // 溢出策略
+    atomic<size_t> nBlocked;               // 阻塞等待空间的提交者数量（很少写入）
+    atomic<bool> closed;                   // 已开始关闭，拒绝外部线程的提交
+    atomic<bool> cancelling;               // 后台线程不再取新任务（Cancel 或排空超时）
+    vector<unique_ptr<LocalDeque>> deques; // 每个后台线程一个本地双端队列
+    shared_ptr<TimerService> timers;       // 延迟/周期任务（TimerHandle 只持有其弱引用）
+
+    // 提交者与后台线程都会写入
+    alignas(CacheLineSize) atomic<size_t> queued; // 全局队列中已占用的容量名额（仅在设置了容量上限时统计）
+    atomic<size_t> dropped;                // 被溢出策略丢弃的任务数
+
+    // 后台线程在每次 run() 的进入/退出时、帮忙执行的线程在每次 runPendingTask() 前后写入，shutdown() 据此判断是否排空
+    alignas(CacheLineSize) atomic<size_t> busy; // 正在 run() 或 runPendingTask() 中的线程数
+
+    std::mutex shutdownMutex;              // 串行化 shutdown()
+    bool finished;                         // shutdown() 已完成（受 shutdownMutex 保护）
+
+#ifdef LMC_ENABLE_STATS
+    /**
+     * 每个后台线程的统计，只由该线程写入，各自独占缓存行
+     */
+    struct alignas(CacheLineSize) WorkerCounters {
+        atomic<uint64_t> executed{0};
+        atomic<uint64_t> steals{0};
+        LatencyHistogram waitTime;
+        LatencyHistogram runTime;
+    };
+
+    static void bump(atomic<uint64_t> &c) {
+        c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    vector<unique_ptr<WorkerCounters>> counters;
+    atomic<uint64_t> externalExecuted;     // 非后台线程执行的任务数（多个线程写入）
+#endif
+
+private:
+    // 慢路径
+    alignas(CacheLineSize) std::mutex spaceMutex; // 与 spaceCv 配合，等待全局队列腾出空间
+    condition_variable spaceCv;
+
+    std::mutex handlerMutex;                      // 保护 exceptionHandler
+    function<void(exception_ptr)> exceptionHandler; // post() 任务的异常处理函数
+};
+
+/**
+ * BasicWorkQueue - 按编译期策略特化的任务队列
+ *
+ * LockPolicy 为保护全局队列的锁类型，QueuePolicy 为全局队列的实现（见 LinkedQueue/RingQueue）。
+ * 锁与队列在编译期确定：入队/出队路径中没有按互斥类型的分支与间接调用，加锁可被完全内联，
+ * 对象中也只包含所选策略需要的成员。需要在运行期选择策略时使用 WorkQueue(MutexType)。
+ *
+ * 功能与调度顺序见 WorkQueue。
+ */
+template <typename LockPolicy, typename QueuePolicy = LinkedQueue>
+class BasicWorkQueue final : public WorkQueueBase,
+                             public QueueFrontend<BasicWorkQueue<LockPolicy, QueuePolicy>> {
+    using Lanes = LaneStorage<LockPolicy, QueuePolicy>;
+
+public:
+    /**
+     * 全局队列是否只允许一个消费者 / 一个生产者（SpscRing），单消费者时固定只有 1 个后台线程
+     */
+    static constexpr bool SingleConsumer = Lanes::SingleConsumer;
+    static constexpr bool SingleProducer = Lanes::SingleProducer;
+
+    /**
+     * workers: 后台线程数量，默认为硬件并发数；SingleConsumer 时忽略该参数，固定为 1
+     */
+    explicit BasicWorkQueue(size_t workers = thread::hardware_concurrency())
+        : BasicWorkQueue(ElasticPolicy{workers, workers}) {}
+
+    /**
+     * 弹性线程数：按负载在 [minWorkers, maxWorkers] 之间增减后台线程（见 ElasticPolicy），
+     * 积压以全局通道与本地队列中的任务数衡量；SingleConsumer 时固定为 1 个后台线程
+     */
+    explicit BasicWorkQueue(const ElasticPolicy &policy)
+        : WorkQueueBase(SingleConsumer ? ElasticPolicy{1, 1} : policy) {
+        startElastic();
+    }
+
+    /**
+     * 析构函数：尚未调用 shutdown() 时以 ShutdownMode::Drain 关闭（不限时），已入队的任务都会执行；
+     * shutdown() 中调用基类的 destory() 停止并 join 后台线程，确保析构时不会因为基类线程调用纯虚函数导致崩溃
+     */
+    ~BasicWorkQueue() {
+        shutdown(ShutdownMode::Drain);
+    }
+
+    BasicWorkQueue(const BasicWorkQueue &) = delete;
+    BasicWorkQueue(BasicWorkQueue &&) = delete;
+    BasicWorkQueue &operator=(BasicWorkQueue &&) = delete;
+
+    /**
+     * 底层提交接口：将任务放入当前后台线程的本地双端队列（若在后台线程中调用且为 Normal 优先级）
+     * 或对应优先级的全局通道，并唤醒一个后台线程。
+     * 全局队列已满时按溢出策略处理，tryOnly 为 true 时直接失败。
+     * 返回任务是否已入队（被丢弃或已在调用线程中执行时返回 false）
+     */
+    bool submit(Task &&task, Priority priority, bool tryOnly = false) {
+        if (rejectExternal()) {
+            task = nullptr;
+            return false;
+        }
+        if (!enqueue(move(task), priority, tryOnly))
+            return false;
+        start();
+        return true;
+    }
+
+    /**
+     * 批量提交已构造好的任务：一次加锁入队，一次唤醒（唤醒数为 min(任务数, 后台线程数)）
+     */
+    void submitBatch(vector<Task> &&tasks) {
+        if (tasks.empty())
+            return;
+        if (rejectExternal()) {
+            tasks.clear();
+            return;
+        }
+
+        enqueueBatch(tasks);
+        start(tasks.size());
+        tasks.clear();
+    }
+
+    /**
+     * 登记定时任务；已到期时直接入队。登记后唤醒一个后台线程，使其按新的到期时刻重新阻塞
+     */
+    TimerHandle schedule(chrono::steady_clock::time_point when, Task &&task,
+                         chrono::steady_clock::duration period);
+
+#ifdef LMC_HAS_COROUTINES
+    using QueueFrontend<BasicWorkQueue<LockPolicy, QueuePolicy>>::schedule;   // co_await queue.schedule()
+#endif
+
+    /**
+     * 在调用线程中取出并执行一个待处理的任务，没有可执行的任务时返回 false
+     *
+     * 用于等待方“帮忙执行”：等待其他任务完成的线程可以循环调用该方法，而不是阻塞空等。
+     * SingleConsumer 的全局队列不允许第二个消费者，此时外部线程调用只会窃取本地队列中的任务。
+     */
+    bool runPendingTask() {
+        // 与 run() 相同，先计入 busy 再取任务：任务取出后不在任何队列中，shutdown(Drain) 须等它执行完
+        busy.fetch_add(1);
+        Task f;
+        bool found = dequeue(f);
+        if (found) {
+            const void *outer = tlsHelpingQueue;
+            tlsHelpingQueue = this;
+            execute(f);
+            tlsHelpingQueue = outer;
+        }
+        busy.fetch_sub(1);
+        return found;
+    }
+
+    /**
+     * 显式停止工作队列的唤醒（不等同于销毁线程）
+     */
+    void stopWorkQueue() {
+        stop();
+    }
+
+    /**
+     * 关闭队列并停止所有后台线程，返回是否所有已入队的任务都已执行（没有任务被丢弃）
+     *
+     * - 调用后立即拒绝外部线程的新提交：addTask 的 future 得到 broken_promise，tryAddTask 返回空，
+     *   阻塞等待空间的提交者放弃提交；后台线程（或通过 runPendingTask() 帮忙执行的线程）执行任务期间提交的子任务照常接受
+     * - 尚未到期的延迟/周期任务全部取消；已在队列中或正在执行的周期任务执行完这一次后不再重新登记
+     * - Drain: 唤醒所有后台线程并行执行剩余任务，直到全部执行完毕（包括其他线程正在通过 runPendingTask() 执行的任务）
+     *   或超过 timeout；
+     *   超时后正在执行的任务继续执行完，其余任务被丢弃
+     * - Cancel: 正在执行的任务执行完毕后退出，其余任务被丢弃
+     * - 不持有任何队列锁等待后台线程退出，与之并发的提交者不会被阻塞；
+     *   与 shutdown() 并发的提交可能被执行，也可能被丢弃
+     * - 可重复调用，之后的调用直接返回 true；不应在本队列的任务中调用
+     */
+    bool shutdown(ShutdownMode mode = ShutdownMode::Drain,
+                  chrono::steady_clock::duration timeout = chrono::steady_clock::duration::max());
+
+    /**
+     * 统计快照（见 WorkQueueStats）；可在任意线程随时调用，各计数之间只是近似一致
+     */
+    WorkQueueStats stats() const {
+        WorkQueueStats out;
+        collectStats(out);
+        out.queuedGlobal = lanes.count();
+        out.lockContentions = lanes.contentions();
+        return out;
+    }
+
+protected:
+    /**
+     * 弹性线程数的积压判断：全局通道与本地队列中的任务总数
+     */
+    size_t backlog() override {
+        return lanes.count() + localCount();
+    }
+
+    /**
+     * run() - 后台线程每次被唤醒后调用该函数
+     *
+     * 实现逻辑：
+     * - 按 High 通道 -> 本地双端队列 -> Normal/Low 通道 -> 窃取其他线程 的顺序取出任务并执行，
+     *   并按固定比例优先检查 Normal/Low 通道（加权公平），低优先级任务不会被永久饿死
+     * - 每取一个任务前检查一次到期的定时器；shutdown() 取消剩余任务后不再取新任务
+     * - 循环执行直到所有队列均为空后返回，后台线程随后阻塞等待下一次唤醒
+     * - 任务在不持锁的情况下执行，避免长时间持锁阻塞其他提交者
+     */
+    void run() override {
+        busy.fetch_add(1);
+        Task f;
+        while (!cancelling.load(memory_order_relaxed)) {
+            serviceTimers();
+            if (!dequeue(f))
+                break;
+            execute(f);
+        }
+        busy.fetch_sub(1);
+    }
+
+private:
+    bool enqueue(Task &&task, Priority priority, bool tryOnly);
+
+    /**
+     * 为即将放入全局通道的任务占用一个容量名额，返回 false 表示任务不入队（已按溢出策略处理）
+     */
+    bool admit(Task &task, bool tryOnly);
+
+    /**
+     * 按 Low -> Normal -> High 的顺序丢弃一个最早入队的任务，其容量名额直接转给新任务
+     */
+    bool dropOldest();
+
+    /**
+     * 放入/取出指定的全局优先级通道；环形队列已满时让出 CPU，等待后台线程消费（自然形成背压），
+     * 等待期间队列被关闭时放弃并返回 false
+     */
+    bool pushLane(size_t lane, Task &&task) {
+        while (!lanes.tryPush(lane, task)) {
+            if (closed.load(memory_order_acquire)) {
+                task = nullptr;
+                return false;
+            }
+            start();
+            this_thread::yield();
+        }
+        return true;
+    }
+
+    bool popLane(size_t lane, Task &task) {
+        if (!lanes.take(lane, task))
+            return false;
+        if (maxQueued != 0)
+            releaseSlot();
+        return true;
+    }
+
+    /**
+     * 批量入队：后台线程中调用时放入本地双端队列，否则放入全局队列
+     */
+    void enqueueBatch(vector<Task> &tasks);
+
+    /**
+     * 按调度顺序取出一个任务，没有可执行的任务时返回 false
+     */
+    bool dequeue(Task &task);
+
+    /**
+     * 取出到期的定时器并入队执行（由后台线程在 run() 中调用，未到期时只有一次原子读取）
+     */
+    void serviceTimers();
+
+    /**
+     * 执行一次周期任务并重新登记
+     */
+    void runPeriodic(const shared_ptr<TimerNode> &node);
+
+    Lanes lanes;
+};
+
+/**
+ * 排空判断：任务要么在某个队列中，要么被正在 run() 中的后台线程或正在 runPendingTask() 中帮忙执行的线程持有；
+ * 关闭后只有这些线程会提交，因此 busy 为 0 且所有队列为空时不会再出现新任务。
+ * 两次读取 busy 排除检查队列期间有线程进出 run() / runPendingTask()。
+ */
+template <typename LockPolicy, typename QueuePolicy>
+bool BasicWorkQueue<LockPolicy, QueuePolicy>::shutdown(ShutdownMode mode,
+                                                       chrono::steady_clock::duration timeout) {
+    lock_guard<std::mutex> lock(shutdownMutex);
+    if (finished)
+        return true;
+
+    closed.store(true);
+    wakeBlocked();
+    timers->close();
+
+    auto idle = [this] {
+        return busy.load() == 0 && lanes.empty() && localEmpty() && busy.load() == 0;
+    };
+
+    bool complete = true;
+    if (mode == ShutdownMode::Drain) {
+        auto now = chrono::steady_clock::now();
+        auto deadline = timeout >= chrono::steady_clock::time_point::max() - now
+                        ? chrono::steady_clock::time_point::max() : now + timeout;
+
+        // 每次检查都重新唤醒：与之并发的 stopWorkQueue() 可能清除了唤醒次数，
+        // 后台线程随后阻塞，已入队的任务无人执行，排空将永远等待
+        while (!idle()) {
+            if (chrono::steady_clock::now() >= deadline) {
+                complete = false;
+                break;
+            }
+            start(workerCount());
+            this_thread::sleep_for(chrono::microseconds(50));
+        }
+    } else {
+        complete = idle();
+    }
+
+    // 正在执行的任务执行完毕后不再取新任务；单消费者的通道不能与后台线程并发清空，留到线程退出之后
+    cancelling.store(true);
+    if constexpr (!SingleConsumer)
+        lanes.clear();
+    destory();
+    lanes.clear();
+    discardLocal();
+
+    finished = true;
+    return complete;
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+bool BasicWorkQueue<LockPolicy, QueuePolicy>::enqueue(Task &&task, Priority priority, bool tryOnly) {
+    // 单生产者的全局队列只留给外部提交者，后台线程的提交不论优先级都进入本地队列
+    markEnqueued(task);
+    size_t idx = workerIndex();
+    if (idx != npos && (priority == Priority::Normal || SingleProducer)) {
+        pushLocal(idx, move(task));
+        return true;
+    }
+
+    if (!admit(task, tryOnly))
+        return false;
+    return pushLane(static_cast<size_t>(priority), move(task));
+}
+
+/**
+ * 容量名额通过 CAS 占用，名额数严格不超过 maxQueued。
+ * Block 策略下提交者先登记 nBlocked 再检查 queued，消费者先释放 queued 再检查 nBlocked，
+ * 两者均为顺序一致的原子操作，且等待与通知都在同一个互斥体下进行，不会丢失唤醒。
+ */
+template <typename LockPolicy, typename QueuePolicy>
+bool BasicWorkQueue<LockPolicy, QueuePolicy>::admit(Task &task, bool tryOnly) {
+    if (maxQueued == 0)
+        return true;
+
+    // 后台线程的提交只计数不限制：否则所有后台线程都可能在等待空间，没有人再消费
+    if (workerIndex() != npos) {
+        queued.fetch_add(1);
+        return true;
+    }
+
+    for (;;) {
+        if (tryReserveSlot())
+            return true;
+        if (tryOnly)
+            return false;
+
+        switch (overflow) {
+            case OverflowPolicy::Block:
+                waitForSpace();
+                if (closed.load()) {
+                    task = nullptr;
+                    return false;
+                }
+            break;
+            case OverflowPolicy::Reject:
+                dropped.fetch_add(1, memory_order_relaxed);
+                task = nullptr;
+            return false;
+            case OverflowPolicy::DropOldest:
+                if constexpr (SingleProducer) {
+                    dropped.fetch_add(1, memory_order_relaxed);
+                    task = nullptr;
+                    return false;
+                }
+                if (dropOldest())
+                    return true;
+                // 名额全部被尚未入队的任务占用（其他提交者正在入队），稍后重试
+                this_thread::yield();
+            break;
+            case OverflowPolicy::CallerRuns:
+                execute(task);
+            return false;
+        }
+    }
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+bool BasicWorkQueue<LockPolicy, QueuePolicy>::dropOldest() {
+    Task victim;
+    for (size_t lane = LaneCount; lane-- > 0;) {
+        if (lanes.take(lane, victim)) {
+            dropped.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+void BasicWorkQueue<LockPolicy, QueuePolicy>::enqueueBatch(vector<Task> &tasks) {
+    const size_t lane = static_cast<size_t>(Priority::Normal);
+#ifdef LMC_TASK_ENQUEUE_TIME
+#ifndef LMC_ENABLE_STATS
+    if (trace::active())
+#endif
+    {
+        int64_t now = trace::now();
+        for (auto &t : tasks)
+            t.setEnqueueTime(now);
+    }
+#endif
+
+    size_t idx = workerIndex();
+    if (idx != npos) {
+        for (auto &t : tasks)
+            pushLocal(idx, move(t));
+        return;
+    }
+
+    // 设置了容量上限时逐个占用名额（可能阻塞或按策略处理），不再整批加锁
+    if (maxQueued != 0) {
+        for (auto &t : tasks)
+            if (admit(t, false))
+                pushLane(lane, move(t));
+        return;
+    }
+
+    if constexpr (is_same<QueuePolicy, LinkedQueue>::value) {
+        // 整批任务只加锁一次
+        lanes.pushBatch(lane, tasks);
+    } else {
+        for (auto &t : tasks) {
+            while (!lanes.tryPush(lane, t)) {
+                if (closed.load(memory_order_acquire))
+                    return;
+                start(workerCount());
+                this_thread::yield();
+            }
+        }
+    }
+}
+
+/**
+ * 每个线程的取任务计数，用于加权公平：每 16 次优先检查一次 Low，每 4 次优先检查一次 Normal
+ */
+inline thread_local unsigned tlsDequeueTick = 0;
+
+template <typename LockPolicy, typename QueuePolicy>
+bool BasicWorkQueue<LockPolicy, QueuePolicy>::dequeue(Task &task) {
+    const size_t high = static_cast<size_t>(Priority::High);
+    const size_t normal = static_cast<size_t>(Priority::Normal);
+    const size_t low = static_cast<size_t>(Priority::Low);
+
+    size_t idx = workerIndex();
+
+    // 单消费者的全局队列只允许后台线程消费
+    bool global = !SingleConsumer || idx != npos;
+
+    // 0. 加权公平：按固定比例先让低优先级通道取一次，避免被高优先级任务永久饿死
+    unsigned tick = ++tlsDequeueTick;
+    if (global && (tick % 16) == 0 && popLane(low, task))
+        return true;
+    if (global && (tick % 4) == 0 && popLane(normal, task))
+        return true;
+
+    // 1. High 通道（关键路径任务优先于一切）
+    if (global && popLane(high, task))
+        return true;
+
+    // 2. 本线程的本地队列（LIFO，缓存友好）
+    if (idx != npos && popLocal(idx, task))
+        return true;
+
+    // 3. Normal、Low 通道
+    if (global && (popLane(normal, task) || popLane(low, task)))
+        return true;
+
+    // 4. 从其他线程的本地队列窃取
+    return steal(idx, task);
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+TimerHandle BasicWorkQueue<LockPolicy, QueuePolicy>::schedule(chrono::steady_clock::time_point when,
+                                                              Task &&task,
+                                                              chrono::steady_clock::duration period) {
+    if (rejectExternal()) {
+        task = nullptr;
+        return TimerHandle();
+    }
+
+    bool dueNow = false;
+    shared_ptr<TimerNode> node = timers->arm(when, move(task), period, dueNow);
+    if (!dueNow) {
+        // 唤醒一个后台线程，使其在阻塞前按新的最早到期时刻限时等待
+        start();
+    } else if (period == chrono::steady_clock::duration::zero()) {
+        this->post(move(node->task));
+    } else {
+        this->post([this, node] { runPeriodic(node); });
+    }
+    return TimerHandle(timers, node);
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+void BasicWorkQueue<LockPolicy, QueuePolicy>::serviceTimers() {
+    if (timers->empty())
+        return;
+    auto now = chrono::steady_clock::now();
+    if (now < timers->nextDeadline())
+        return;
+
+    vector<shared_ptr<TimerNode>> due;
+    timers->collect(now, due);
+    if (due.empty())
+        return;
+
+    for (auto &node : due) {
+        if (node->period == chrono::steady_clock::duration::zero())
+            enqueue(move(node->task), Priority::Normal, false);
+        else
+            enqueue(Task([this, node] { runPeriodic(node); }), Priority::Normal, false);
+    }
+    start(due.size());
+}
+
+template <typename LockPolicy, typename QueuePolicy>
+void BasicWorkQueue<LockPolicy, QueuePolicy>::runPeriodic(const shared_ptr<TimerNode> &node) {
+    // 到期后在队列中等待期间可能已被取消（cancel() 已返回 true），此时不再执行
+    if (!timers->beginRun(node))
+        return;
+
+    try {
+        node->task();
+    } catch (...) {
+        handleException(current_exception());
+    }
+
+    // 按上次到期时刻计算下一次，避免执行耗时造成累积漂移；已经错过时立即执行。
+    // shutdown() 关闭定时器之后 rearm 返回 false 且不置 dueNow，周期任务就此结束
+    bool dueNow = false;
+    if (timers->rearm(node, node->deadline + node->period, dueNow))
+        start();
+    else if (dueNow)
+        this->post([this, node] { runPeriodic(node); });
+}
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef CANCEL_H_
+#define CANCEL_H_
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace lmc {
+
+/**
+ * TaskCancelled - 带取消令牌提交的任务在开始执行前已被取消时，其 future / Future 得到该异常
+ */
+class TaskCancelled : public std::exception {
+public:
+    const char *what() const noexcept override {
+        return "task cancelled";
+    }
+};
+
+class CancellationSource;
+
+/**
+ * CancellationToken - 取消令牌（只读端），复制开销为一次引用计数
+ *
+ * - 提交时传入（addTask / post / async 的 token 重载）：任务开始执行前检查一次，已取消则跳过，
+ *   不扫描、不修改队列，被跳过的任务只在出队时付出一次原子读取的代价
+ * - 长任务在执行中以 isCancelled() 协作检查，提前返回；任务内部也可以通过 CancellationToken::current()
+ *   取得提交时的令牌，不必显式捕获
+ * - 默认构造的令牌永远不会被取消
+ */
+class CancellationToken {
+public:
+    CancellationToken() noexcept = default;
+
+    bool isCancelled() const noexcept {
+        return state && state->load(std::memory_order_acquire);
+    }
+
+    /**
+     * 是否关联了 CancellationSource（默认构造的令牌返回 false）
+     */
+    bool canBeCancelled() const noexcept {
+        return static_cast<bool>(state);
+    }
+
+    /**
+     * 已取消时抛出 TaskCancelled，用于长任务中的检查点
+     */
+    void throwIfCancelled() const {
+        if (isCancelled())
+            throw TaskCancelled();
+    }
+
+    /**
+     * 当前线程正在执行的带令牌任务的令牌；不在这样的任务中时返回永不取消的空令牌
+     */
+    static const CancellationToken &current() noexcept;
+
+private:
+    friend class CancellationSource;
+
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> s) noexcept : state(std::move(s)) {}
+
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+/**
+ * CancellationSource - 取消令牌的控制端；复制后的各个副本控制同一组令牌
+ *
+ * 典型用途是请求超时：为每个请求创建一个 source，把 token() 随请求的各个任务一起提交，
+ * 超时（例如 queue.postAfter(timeout, [src] { src.cancel(); })）或调用方放弃时 cancel()，
+ * 尚未开始的任务不再执行，正在执行的任务在下一个检查点退出。
+ */
+class CancellationSource {
+public:
+    CancellationSource() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken token() const noexcept {
+        return CancellationToken(state);
+    }
+
+    /**
+     * 请求取消（可重复调用、可在任意线程调用），返回是否是第一次取消
+     */
+    bool cancel() const noexcept {
+        return !state->exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool isCancelled() const noexcept {
+        return state->load(std::memory_order_acquire);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state;
+};
+
+namespace cancel {
+
+inline thread_local const CancellationToken *currentToken = nullptr;
+
+/**
+ * Scope - 执行带令牌的任务期间把令牌设为当前线程的 current()，结束时恢复
+ * （等待时在调用线程中帮忙执行的任务会嵌套）
+ */
+class Scope {
+public:
+    explicit Scope(const CancellationToken &token) noexcept : previous(currentToken) {
+        currentToken = &token;
+    }
+
+    ~Scope() {
+        currentToken = previous;
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const CancellationToken *previous;
+};
+
+/**
+ * Guarded - 提交时与令牌绑定的可调用对象：已取消时抛出 TaskCancelled 而不调用 fn
+ */
+template <typename F>
+class Guarded {
+public:
+    template <typename G>
+    Guarded(const CancellationToken &t, G &&g) : token(t), fn(std::forward<G>(g)) {}
+
+    template <typename ...A>
+    auto operator()(A &&...a) -> decltype(std::invoke(std::declval<F>(), std::forward<A>(a)...)) {
+        token.throwIfCancelled();
+        Scope scope(token);
+        return std::invoke(std::move(fn), std::forward<A>(a)...);
+    }
+
+private:
+    CancellationToken token;
+    F fn;
+};
+
+/**
+ * Skippable - post() 的令牌版本：已取消时直接返回，不抛出异常（异常会被交给队列的异常处理函数）
+ */
+template <typename F>
+class Skippable {
+public:
+    template <typename G>
+    Skippable(const CancellationToken &t, G &&g) : token(t), fn(std::forward<G>(g)) {}
+
+    void operator()() {
+        if (token.isCancelled())
+            return;
+        Scope scope(token);
+        fn();
+    }
+
+private:
+    CancellationToken token;
+    F fn;
+};
+}
+
+inline const CancellationToken &CancellationToken::current() noexcept {
+    static const CancellationToken never;
+    return cancel::currentToken ? *cancel::currentToken : never;
+}
+}
+
+#endif
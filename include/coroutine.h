@@ -0,0 +1,290 @@
+#ifndef COROUTINE_H_
+#define COROUTINE_H_
+
+/**
+ * C++20 协程支持：只有编译器与标准库都支持协程（例如 -std=c++20）时才可用，
+ * 此时定义 LMC_HAS_COROUTINES；以 C++17 编译时本文件为空，其余接口不受影响。
+ *
+ * - co_await queue.schedule(): 把当前协程转移到队列的后台线程上继续执行（见 QueueFrontend::schedule）
+ * - CoTask<T>: 惰性启动的协程类型，co_await 时开始执行，完成时直接恢复等待方（对称转移），
+ *   不经过互斥体与条件变量
+ * - co_await future: 等待 Future<T>（见 future.h）而不阻塞线程
+ * - spawn(queue, task): 在队列中启动一个 CoTask，返回其结果的 Future，用于从普通代码发起协程
+ */
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define LMC_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef LMC_HAS_COROUTINES
+
+#include "future.h"
+#include "src/util/poolalloc.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace lmc {
+
+template <typename T>
+class CoTask;
+
+namespace coro {
+
+/**
+ * PromiseBase - CoTask 的 promise_type 公共部分
+ *
+ * 协程帧从内存池分配（超过池的最大块时退化为 ::operator new）；
+ * 协程结束时对称转移到等待方，没有等待方时挂起在结束点，由 CoTask 析构时销毁帧。
+ */
+struct PromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    static void *operator new(size_t n) {
+        return poolAllocate(n);
+    }
+
+    static void operator delete(void *p, size_t n) {
+        poolDeallocate(p, n);
+    }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+};
+
+template <typename T>
+struct PromiseType : PromiseBase {
+    CoTask<T> get_return_object() noexcept;
+
+    template <typename V>
+    void return_value(V &&v) {
+        value.emplace(std::forward<V>(v));
+    }
+
+    T take() {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template <>
+struct PromiseType<void> : PromiseBase {
+    CoTask<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void take() {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+}
+
+/**
+ * CoTask - 返回 T 的协程（只可移动）
+ *
+ * 惰性启动：协程体在第一次被 co_await 时才开始执行，且在等待方的线程中执行；
+ * 结束时直接恢复等待方，异常在等待方的 co_await 处重新抛出。
+ * 一个 CoTask 只能被 co_await 一次；从普通代码启动使用 spawn()。
+ */
+template <typename T>
+class CoTask {
+public:
+    using promise_type = coro::PromiseType<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    CoTask() noexcept = default;
+
+    CoTask(CoTask &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    CoTask &operator=(CoTask &&other) noexcept {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~CoTask() {
+        if (handle)
+            handle.destroy();
+    }
+
+    CoTask(const CoTask &) = delete;
+    CoTask &operator=(const CoTask &) = delete;
+
+    bool valid() const noexcept {
+        return static_cast<bool>(handle);
+    }
+
+    bool done() const noexcept {
+        return handle && handle.done();
+    }
+
+    auto operator co_await() && noexcept {
+        return Awaiter{handle};
+    }
+
+    auto operator co_await() & noexcept {
+        return Awaiter{handle};
+    }
+
+private:
+    friend promise_type;
+
+    explicit CoTask(Handle h) noexcept : handle(h) {}
+
+    struct Awaiter {
+        bool await_ready() const noexcept {
+            return h.done();
+        }
+
+        /**
+         * 对称转移：登记等待方后直接切换到协程体，不经过调度器，也不增加调用栈深度
+         * （GCC 只在开启优化时把切换生成为尾调用，-O0/-O1 下极深的同步 co_await 链仍会消耗栈）
+         */
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            h.promise().continuation = awaiting;
+            return h;
+        }
+
+        T await_resume() {
+            return h.promise().take();
+        }
+
+        Handle h;
+    };
+
+    Handle handle;
+};
+
+namespace coro {
+
+template <typename T>
+CoTask<T> PromiseType<T>::get_return_object() noexcept {
+    return CoTask<T>(CoTask<T>::Handle::from_promise(*this));
+}
+
+inline CoTask<void> PromiseType<void>::get_return_object() noexcept {
+    return CoTask<void>(CoTask<void>::Handle::from_promise(*this));
+}
+
+/**
+ * Detached - 立即开始、结束时自行销毁的协程，只用于 spawn() 的驱动协程
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept {
+            return {};
+        }
+        std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+    };
+};
+
+template <typename T>
+Detached drive(CoTask<T> task, Promise<T> p) {
+    try {
+        if constexpr (std::is_void<T>::value) {
+            co_await std::move(task);
+            p.setValue();
+        } else {
+            p.setValue(co_await std::move(task));
+        }
+    } catch (...) {
+        p.setException(std::current_exception());
+    }
+}
+
+/**
+ * FutureAwaiter - co_await Future<T> 的等待器：Future 就绪时在完成它的线程中恢复协程
+ */
+template <typename T>
+struct FutureAwaiter {
+    bool await_ready() const {
+        return state->ready();
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        state->onReady(Task([h] { h.resume(); }));
+    }
+
+    T await_resume() {
+        if constexpr (std::is_void<T>::value)
+            state->take();
+        else
+            return state->take();
+    }
+
+    std::shared_ptr<fut::State<T>> state;
+};
+}
+
+/**
+ * co_await future：不阻塞线程，Future 就绪时在完成它的线程中恢复（需要换回队列时随后 co_await queue.schedule()）
+ */
+template <typename T>
+coro::FutureAwaiter<T> operator co_await(Future<T> &&f) {
+    return coro::FutureAwaiter<T>{f.release()};
+}
+
+/**
+ * 在 queue 的后台线程中启动 task，返回其结果的 Future（then() 默认提交到 queue）；
+ * 队列已关闭时 task 不会执行，Future 得到 broken_promise
+ */
+template <typename Queue, typename T>
+Future<T> spawn(Queue &queue, CoTask<T> task) {
+    Promise<T> p{Executor(queue)};
+    Future<T> result = p.getFuture();
+    queue.post([task = std::move(task), p = std::move(p)]() mutable {
+        coro::drive(std::move(task), std::move(p));
+    });
+    return result;
+}
+}
+
+#endif
+
+#endif
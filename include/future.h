@@ -0,0 +1,625 @@
+#ifndef FUTURE_H_
+#define FUTURE_H_
+
+#include "task.h"
+#include "src/util/poolalloc.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lmc {
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+/**
+ * Executor - 续延的提交入口（对队列的类型擦除引用）
+ *
+ * 由队列构造：Executor(queue)，queue 可以是 WorkQueue 或任意 BasicWorkQueue，只需提供 post()。
+ * 空的 Executor 在完成输入的线程中直接执行续延。Executor 不持有队列，队列必须比使用它的续延活得更久；
+ * 队列关闭后提交的续延被丢弃，对应的 Future 得到 broken_promise。
+ */
+class Executor {
+public:
+    Executor() noexcept : queue(nullptr), postFn(nullptr) {}
+
+    template <typename Queue, typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<Queue>::type, Executor>::value>::type>
+    explicit Executor(Queue &q) noexcept
+        : queue(&q), postFn([](void *p, Task &&task) { static_cast<Queue *>(p)->post(std::move(task)); }) {}
+
+    void post(Task &&task) const {
+        if (postFn)
+            postFn(queue, std::move(task));
+        else
+            task();
+    }
+
+    explicit operator bool() const noexcept {
+        return postFn != nullptr;
+    }
+
+private:
+    void *queue;
+    void (*postFn)(void *, Task &&);
+};
+
+namespace fut {
+
+/**
+ * 结果的存放类型：void 以 std::monostate 存放，使 void 与非 void 共用同一套实现
+ */
+template <typename T>
+using Stored = typename std::conditional<std::is_void<T>::value, std::monostate, T>::type;
+
+/**
+ * State - Promise 与 Future 的共享状态
+ *
+ * 结果写入一次；就绪时执行至多一个回调（then / whenAll 等登记的续延），回调在写入结果的线程中、
+ * 锁外执行，只做登记或提交任务之类的轻量工作。只有有线程阻塞等待（get / wait）时才使用条件变量。
+ */
+template <typename T>
+class State {
+public:
+    bool ready() const {
+        return done.load(std::memory_order_acquire);
+    }
+
+    void wait() {
+        if (ready())
+            return;
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return done.load(std::memory_order_relaxed); });
+    }
+
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period> &timeout) {
+        if (ready())
+            return true;
+        std::unique_lock<std::mutex> lock(m);
+        return cv.wait_for(lock, timeout, [this] { return done.load(std::memory_order_relaxed); });
+    }
+
+    void setValue(Stored<T> &&v) {
+        complete([&] { value.emplace(std::move(v)); });
+    }
+
+    void setException(std::exception_ptr e) {
+        complete([&] { error = std::move(e); });
+    }
+
+    /**
+     * 登记就绪回调（至多一个）；已就绪时在调用线程中立即执行
+     */
+    void onReady(Task &&callback) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (!done.load(std::memory_order_relaxed)) {
+                onReadyCallback = std::move(callback);
+                return;
+            }
+        }
+        callback();
+    }
+
+    /**
+     * 取出结果（只能调用一次，必须已就绪）；结果为异常时重新抛出
+     * 异常同样被取走：共享状态可能由写入方线程最后释放，异常对象只由取出结果的线程释放
+     */
+    Stored<T> take() {
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+        return std::move(*value);
+    }
+
+    Executor executor;   // then() 未指定队列时续延提交到这里
+
+private:
+    template <typename Set>
+    void complete(Set &&set) {
+        Task callback;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (done.load(std::memory_order_relaxed))
+                throw std::future_error(std::future_errc::promise_already_satisfied);
+            set();
+            done.store(true, std::memory_order_release);
+            callback = std::move(onReadyCallback);
+        }
+        cv.notify_all();
+        if (callback)
+            callback();
+    }
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<bool> done{false};
+    std::optional<Stored<T>> value;
+    std::exception_ptr error;
+    Task onReadyCallback;
+};
+
+template <typename T>
+struct IsFuture : std::false_type {};
+
+template <typename T>
+struct IsFuture<Future<T>> : std::true_type {};
+
+/**
+ * 续延返回 Future<U> 时结果展开为 Future<U>（等内层完成），而不是 Future<Future<U>>
+ */
+template <typename R>
+struct Unwrap {
+    using type = R;
+};
+
+template <typename U>
+struct Unwrap<Future<U>> {
+    using type = U;
+};
+
+/**
+ * then(f) 中 f 的返回类型：输入为 void 时 f 不接受参数，否则以右值接受输入的结果；
+ * 续延以左值调用保存的 f（见 Future::thenOn），因此按 F & 计算
+ */
+template <typename T, typename F>
+struct ThenResult {
+    using type = std::invoke_result_t<F &, T>;
+};
+
+template <typename F>
+struct ThenResult<void, F> {
+    using type = std::invoke_result_t<F &>;
+};
+
+/**
+ * 调用 g() 并把结果写入 p：g 抛出异常时写入异常；g 返回 Future 时等其完成后转交结果，
+ * 返回的 Future 无效（默认构造或已被取走）时写入 future_error(no_state)
+ */
+template <typename U, typename G>
+void fulfil(Promise<U> &p, G &&g) {
+    using R = decltype(g());
+    try {
+        if constexpr (std::is_void<R>::value) {
+            g();
+            p.setValue();
+        } else if constexpr (IsFuture<R>::value) {
+            R inner = g();
+            auto s = inner.release();
+            if (!s) {
+                // f 返回了无效的 Future：不经 throw 构造异常，异常对象不在本线程的 catch 中多持有一次
+                p.setException(std::make_exception_ptr(std::future_error(std::future_errc::no_state)));
+                return;
+            }
+            State<U> *raw = s.get();
+            raw->onReady(Task([s = std::move(s), p = std::move(p)]() mutable {
+                try {
+                    p.setValue(s->take());
+                } catch (...) {
+                    p.setException(std::current_exception());
+                }
+            }));
+        } else {
+            p.setValue(g());
+        }
+    } catch (...) {
+        p.setException(std::current_exception());
+    }
+}
+}
+
+/**
+ * Promise - Future 的写入端（只可移动）
+ *
+ * 共享状态从内存池分配；Promise 在写入结果之前被销毁（例如任务被丢弃）时，Future 得到 broken_promise。
+ * executor 为结果 Future 上 then(f) 默认使用的队列。
+ */
+template <typename T>
+class Promise {
+public:
+    explicit Promise(Executor executor = Executor())
+        : state(std::allocate_shared<fut::State<T>>(PoolAllocator<fut::State<T>>())) {
+        state->executor = executor;
+    }
+
+    Promise(Promise &&) noexcept = default;
+
+    Promise &operator=(Promise &&other) noexcept {
+        if (this != &other) {
+            abandon();
+            state = std::move(other.state);
+            retrieved = other.retrieved;
+        }
+        return *this;
+    }
+
+    ~Promise() {
+        abandon();
+    }
+
+    Promise(const Promise &) = delete;
+    Promise &operator=(const Promise &) = delete;
+
+    /**
+     * 取得对应的 Future（只能调用一次）
+     */
+    Future<T> getFuture() {
+        if (!state || retrieved)
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        retrieved = true;
+        return Future<T>(state);
+    }
+
+    /**
+     * 写入结果：T 为 void 时不带参数，否则传入一个可转换为 T 的值
+     */
+    template <typename ...V>
+    void setValue(V &&...v) {
+        state->setValue(fut::Stored<T>(std::forward<V>(v)...));
+    }
+
+    void setException(std::exception_ptr e) {
+        state->setException(std::move(e));
+    }
+
+private:
+    void abandon() noexcept {
+        if (state && !state->ready()) {
+            try {
+                state->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            } catch (...) {}
+        }
+    }
+
+    std::shared_ptr<fut::State<T>> state;
+    bool retrieved = false;
+};
+
+/**
+ * Future - 支持续延的结果句柄（只可移动，结果只能取出一次）
+ *
+ * 与 std::future 相比，可以登记续延而不阻塞线程：
+ * - then(f): 本 Future 就绪后把 f(结果) 作为任务提交到队列（默认为产生本 Future 的队列），
+ *   返回 f 结果的 Future；f 返回 Future<U> 时结果为 Future<U>（等内层完成，内层无效时得到 future_error(no_state)）
+ * - then(queue, f): 同上，但提交到指定队列
+ * - 本 Future 的结果为异常时跳过 f，异常直接传给 then() 返回的 Future
+ * - then() 消耗本 Future（之后 valid() 为 false），一个 Future 只能登记一个续延
+ *
+ * get() / wait() 阻塞调用线程；在队列的任务中等待应使用 then()、whenAll() 或 queue.wait(f)（帮忙执行）。
+ */
+template <typename T>
+class Future {
+public:
+    Future() noexcept = default;
+    Future(Future &&) noexcept = default;
+    Future &operator=(Future &&) noexcept = default;
+
+    Future(const Future &) = delete;
+    Future &operator=(const Future &) = delete;
+
+    bool valid() const noexcept {
+        return state != nullptr;
+    }
+
+    /**
+     * 结果（值或异常）是否已就绪，不阻塞
+     */
+    bool ready() const {
+        return state->ready();
+    }
+
+    void wait() const {
+        state->wait();
+    }
+
+    /**
+     * 与 std::future::wait_for 相同，使 queue.wait(f) 同样适用于 Future
+     */
+    template <typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+        return state->waitFor(timeout) ? std::future_status::ready : std::future_status::timeout;
+    }
+
+    /**
+     * 阻塞直到就绪并取出结果（之后 valid() 为 false）；结果为异常时重新抛出
+     */
+    T get() {
+        state->wait();
+        auto s = std::move(state);
+        if constexpr (std::is_void<T>::value)
+            s->take();
+        else
+            return s->take();
+    }
+
+    template <typename F>
+    auto then(F &&f) ->
+    Future<typename fut::Unwrap<typename fut::ThenResult<T, typename std::decay<F>::type>::type>::type> {
+        Executor executor = state->executor;
+        return thenOn(executor, std::forward<F>(f));
+    }
+
+    template <typename Queue, typename F>
+    auto then(Queue &queue, F &&f) ->
+    Future<typename fut::Unwrap<typename fut::ThenResult<T, typename std::decay<F>::type>::type>::type> {
+        return thenOn(Executor(queue), std::forward<F>(f));
+    }
+
+    /**
+     * 内部使用：交出共享状态（之后 valid() 为 false）
+     */
+    std::shared_ptr<fut::State<T>> release() noexcept {
+        return std::move(state);
+    }
+
+private:
+    friend class Promise<T>;
+
+    explicit Future(std::shared_ptr<fut::State<T>> s) noexcept : state(std::move(s)) {}
+
+    template <typename F>
+    auto thenOn(Executor executor, F &&f) ->
+    Future<typename fut::Unwrap<typename fut::ThenResult<T, typename std::decay<F>::type>::type>::type> {
+        using Fn = typename std::decay<F>::type;
+        using U = typename fut::Unwrap<typename fut::ThenResult<T, Fn>::type>::type;
+
+        Promise<U> p(executor);
+        Future<U> result = p.getFuture();
+        auto src = std::move(state);
+        fut::State<T> *raw = src.get();
+
+        // 就绪回调只负责提交：续延本身在队列中执行，不占用写入结果的线程
+        raw->onReady(Task([src = std::move(src), p = std::move(p), fn = Fn(std::forward<F>(f)),
+                           executor]() mutable {
+            executor.post(Task([src = std::move(src), p = std::move(p), fn = std::move(fn)]() mutable {
+                fut::fulfil(p, [&]() -> typename fut::ThenResult<T, Fn>::type {
+                    if constexpr (std::is_void<T>::value) {
+                        src->take();
+                        return fn();
+                    } else {
+                        return fn(src->take());
+                    }
+                });
+            }));
+        }));
+        return result;
+    }
+
+    std::shared_ptr<fut::State<T>> state;
+};
+
+/**
+ * 已就绪的 Future
+ */
+template <typename T>
+Future<typename std::decay<T>::type> makeReadyFuture(T &&value) {
+    Promise<typename std::decay<T>::type> p;
+    Future<typename std::decay<T>::type> f = p.getFuture();
+    p.setValue(std::forward<T>(value));
+    return f;
+}
+
+inline Future<void> makeReadyFuture() {
+    Promise<void> p;
+    Future<void> f = p.getFuture();
+    p.setValue();
+    return f;
+}
+
+namespace fut {
+
+/**
+ * WhenAll - whenAll(vector) 的聚合状态：每个输入就绪时写入对应位置，最后一个写入者完成结果
+ */
+template <typename T>
+struct WhenAll {
+    using Result = typename std::conditional<std::is_void<T>::value, void, std::vector<Stored<T>>>::type;
+
+    WhenAll(size_t n, Executor executor) : values(n), remaining(n), failed(false), promise(executor) {}
+
+    void arrive(size_t i, State<T> &s) {
+        try {
+            values[i].emplace(s.take());
+        } catch (...) {
+            // 第一个异常立即完成结果，其余输入照常等待（只为释放共享状态）
+            if (!failed.exchange(true, std::memory_order_acq_rel))
+                promise.setException(std::current_exception());
+        }
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1 || failed.load(std::memory_order_acquire))
+            return;
+        if constexpr (std::is_void<T>::value) {
+            promise.setValue();
+        } else {
+            std::vector<T> out;
+            out.reserve(values.size());
+            for (auto &v : values)
+                out.push_back(std::move(*v));
+            promise.setValue(std::move(out));
+        }
+    }
+
+    std::vector<std::optional<Stored<T>>> values;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed;
+    Promise<Result> promise;
+};
+
+/**
+ * WhenAllTuple - 异构 whenAll(f1, f2, ...) 的聚合状态
+ */
+template <typename ...T>
+struct WhenAllTuple {
+    explicit WhenAllTuple(Executor executor) : remaining(sizeof...(T)), failed(false), promise(executor) {}
+
+    template <size_t I, typename S>
+    void arrive(S &s) {
+        try {
+            std::get<I>(values).emplace(s.take());
+        } catch (...) {
+            if (!failed.exchange(true, std::memory_order_acq_rel))
+                promise.setException(std::current_exception());
+        }
+
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1 || failed.load(std::memory_order_acquire))
+            return;
+        promise.setValue(collect(std::index_sequence_for<T...>()));
+    }
+
+    template <size_t ...I>
+    std::tuple<Stored<T>...> collect(std::index_sequence<I...>) {
+        return std::tuple<Stored<T>...>(std::move(*std::get<I>(values))...);
+    }
+
+    std::tuple<std::optional<Stored<T>>...> values;
+    std::atomic<size_t> remaining;
+    std::atomic<bool> failed;
+    Promise<std::tuple<Stored<T>...>> promise;
+};
+
+template <typename All, typename States, size_t ...I>
+void attachAll(const std::shared_ptr<All> &all, States &states, std::index_sequence<I...>) {
+    auto attach = [&](auto &s, auto index) {
+        auto *raw = s.get();
+        raw->onReady(Task([all, s = std::move(s)] { all->template arrive<decltype(index)::value>(*s); }));
+    };
+    (attach(std::get<I>(states), std::integral_constant<size_t, I>()), ...);
+}
+}
+
+/**
+ * WhenAnyResult - whenAny() 的结果：最先成功完成的输入的下标及其结果
+ */
+template <typename T>
+struct WhenAnyResult {
+    size_t index;
+    T value;
+};
+
+template <>
+struct WhenAnyResult<void> {
+    size_t index;
+};
+
+namespace fut {
+
+template <typename T>
+struct WhenAny {
+    WhenAny(size_t n, Executor executor) : remaining(n), won(false), promise(executor) {}
+
+    void arrive(size_t i, State<T> &s) {
+        try {
+            Stored<T> v = s.take();
+            if (!won.exchange(true, std::memory_order_acq_rel)) {
+                if constexpr (std::is_void<T>::value)
+                    promise.setValue(WhenAnyResult<void>{i});
+                else
+                    promise.setValue(WhenAnyResult<T>{i, std::move(v)});
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m);
+            error = std::current_exception();
+        }
+
+        // 全部失败：以最后一个异常完成
+        if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && !won.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m);
+            promise.setException(error);
+        }
+    }
+
+    std::atomic<size_t> remaining;
+    std::atomic<bool> won;
+    std::mutex m;
+    std::exception_ptr error;
+    Promise<WhenAnyResult<T>> promise;
+};
+}
+
+/**
+ * whenAll - 所有输入都成功完成时完成，结果按输入顺序排列（输入为 void 时结果为 void）
+ *
+ * 任一输入失败时以第一个异常立即完成，不等待其余输入。输入的结果在完成它的线程中直接汇总，
+ * 不提交额外的任务；结果 Future 的 then() 默认使用第一个输入所属的队列。空输入立即完成。
+ */
+template <typename T>
+Future<typename fut::WhenAll<T>::Result> whenAll(std::vector<Future<T>> futures) {
+    using Result = typename fut::WhenAll<T>::Result;
+
+    if (futures.empty()) {
+        Promise<Result> p;
+        Future<Result> f = p.getFuture();
+        p.setValue();
+        return f;
+    }
+
+    std::vector<std::shared_ptr<fut::State<T>>> states;
+    states.reserve(futures.size());
+    for (auto &f : futures)
+        states.push_back(f.release());
+
+    auto all = std::make_shared<fut::WhenAll<T>>(states.size(), states.front()->executor);
+    Future<Result> result = all->promise.getFuture();
+    for (size_t i = 0; i < states.size(); ++i) {
+        fut::State<T> *raw = states[i].get();
+        raw->onReady(Task([all, i, s = std::move(states[i])] { all->arrive(i, *s); }));
+    }
+    return result;
+}
+
+/**
+ * whenAll(f1, f2, ...) - 异构版本，结果为各输入结果组成的 tuple（void 输入对应 std::monostate）
+ */
+template <typename ...T>
+Future<std::tuple<fut::Stored<T>...>> whenAll(Future<T> ...futures) {
+    static_assert(sizeof...(T) > 0, "whenAll() requires at least one future");
+    auto states = std::make_tuple(futures.release()...);
+    auto all = std::make_shared<fut::WhenAllTuple<T...>>(std::get<0>(states)->executor);
+    Future<std::tuple<fut::Stored<T>...>> result = all->promise.getFuture();
+    fut::attachAll(all, states, std::index_sequence_for<T...>());
+    return result;
+}
+
+/**
+ * whenAny - 最先成功完成的输入决定结果（WhenAnyResult：下标与结果），其余输入的结果被丢弃
+ *
+ * 全部输入都失败时以最后一个异常完成；空输入得到 broken_promise。
+ */
+template <typename T>
+Future<WhenAnyResult<T>> whenAny(std::vector<Future<T>> futures) {
+    if (futures.empty()) {
+        Promise<WhenAnyResult<T>> p;
+        return p.getFuture();
+    }
+
+    std::vector<std::shared_ptr<fut::State<T>>> states;
+    states.reserve(futures.size());
+    for (auto &f : futures)
+        states.push_back(f.release());
+
+    auto any = std::make_shared<fut::WhenAny<T>>(states.size(), states.front()->executor);
+    Future<WhenAnyResult<T>> result = any->promise.getFuture();
+    for (size_t i = 0; i < states.size(); ++i) {
+        fut::State<T> *raw = states[i].get();
+        raw->onReady(Task([any, i, s = std::move(states[i])] { any->arrive(i, *s); }));
+    }
+    return result;
+}
+}
+
+#endif
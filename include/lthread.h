@@ -2,56 +2,227 @@
 #define THREAD_H
 
 #include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace lmc {
 
+/**
+ * IdlePolicy - 后台线程空闲时的等待策略
+ *
+ * 线程处理完所有工作后，依次经历三个阶段等待下一次唤醒：
+ * 1. 自旋：执行 spinCount 次 CPU pause 提示并检查唤醒，唤醒延迟最低，但占用 CPU
+ * 2. 让出：执行 yieldCount 次 std::this_thread::yield() 并检查唤醒
+ * 3. 阻塞：在条件变量上等待，不占用 CPU，唤醒延迟最高（数十微秒）
+ *
+ * adaptive 为 true 时，每个线程根据最近任务到达情况调整实际自旋次数（上限为 spinCount）：
+ * 在自旋/让出阶段等到了任务则加倍，最终仍需阻塞则减半，任务稀疏时自动回落到接近直接阻塞。
+ *
+ * 默认值（全 0）表示直接阻塞，空闲队列不消耗 CPU。
+ */
+struct IdlePolicy {
+    unsigned spinCount = 0;
+    unsigned yieldCount = 0;
+    bool adaptive = false;
+};
+
+/**
+ * IdleStats - 一个后台线程空闲等待的统计（仅在定义 LMC_ENABLE_STATS 时记录，否则全为 0）
+ * - spinWakeups: 在自旋阶段等到唤醒的次数
+ * - yieldWakeups: 在让出阶段等到唤醒的次数
+ * - parks: 进入阻塞阶段的次数
+ */
+struct IdleStats {
+    uint64_t spinWakeups = 0;
+    uint64_t yieldWakeups = 0;
+    uint64_t parks = 0;
+};
+
+/**
+ * AffinityMode - 后台线程的 CPU 绑定方式（见 AffinityPolicy）
+ * - None: 不绑定，由操作系统调度（默认）
+ * - CoreList: 第 i 个后台线程绑定到 cpus[i % cpus.size()]
+ * - PhysicalCores: 每个物理核一个后台线程（只使用每个核的第一个超线程），依次按 NUMA 节点排列
+ * - NumaNodes: 后台线程按编号连续分组，每组绑定到一个 NUMA 节点的全部 CPU，可在节点内迁移
+ */
+enum class AffinityMode {
+    None,
+    CoreList,
+    PhysicalCores,
+    NumaNodes
+};
+
+/**
+ * AffinityPolicy - 后台线程的 CPU 绑定策略
+ *
+ * 绑定后每个后台线程记录所在的 NUMA 节点（workerNode()）：窃取任务时优先选择同一节点的线程，
+ * 后台线程从内存池分配的小对象（任务节点等）取自该节点的中心池，由本节点的线程首次写入，
+ * 在按首次访问分配物理页的系统（Linux 默认）上位于本节点内存。
+ * 只支持 Linux 与 Windows（最多 64 个逻辑 CPU）；其他平台上 setAffinity() 返回 false，不产生影响。
+ */
+struct AffinityPolicy {
+    AffinityMode mode = AffinityMode::None;
+    std::vector<unsigned> cpus;   // CoreList 使用的逻辑 CPU 编号
+};
+
+/**
+ * ElasticPolicy - 弹性后台线程数
+ *
+ * 构造时只创建 minWorkers 个后台线程，其余线程按负载创建与回收（最多 maxWorkers 个）：
+ * - 增加：监控线程每隔 growAfter 采样一次，连续两次采样都没有阻塞等待的后台线程、
+ *   且待处理任务数（派生类的 backlog()）超过 backlogThreshold 时增加一个线程。
+ *   后台线程全部忙于执行（包括阻塞在 I/O 上的任务）而任务仍在积压，才需要付出创建线程的代价
+ * - 回收：编号不小于 minWorkers 的线程空闲阻塞超过 keepAlive 后退出，编号较小的线程始终保留
+ * maxWorkers 不大于 minWorkers 时线程数固定，不创建监控线程。
+ */
+struct ElasticPolicy {
+    size_t minWorkers = 1;
+    size_t maxWorkers = 1;
+    size_t backlogThreshold = 0;
+    std::chrono::milliseconds growAfter = std::chrono::milliseconds(5);
+    std::chrono::milliseconds keepAlive = std::chrono::milliseconds(10000);
+};
+
 /**
  * Thread - 抽象线程基类
  *
- * 该类封装了一个后台线程的生命周期控制，派生类需要重载纯虚函数 run()
+ * 该类封装了一组后台线程（默认 1 个）的生命周期控制，派生类需要重载纯虚函数 run()
  * 以实现每次被唤醒时需要执行的逻辑。基类通过 pImpl 隐藏实现细节（condition_variable,
  * atomic 等），并提供 start()/stop()/destory() 接口供派生类或使用者控制线程的唤醒与终止。
  *
  * 重要约定：
- * - 后台线程会循环等待条件变量通知；被唤醒后会调用派生类实现的 run() 执行一次任务。
+ * - 后台线程会循环等待条件变量通知；每次被唤醒后调用派生类实现的 run()，
+ *   run() 应处理完当前所有可执行的工作后再返回，随后线程按 IdlePolicy 等待下一次唤醒
+ *   （默认直接阻塞，空闲时不占用 CPU）。
+ * - 多个后台线程共享同一个条件变量，run() 可能被多个线程并发调用，派生类需自行保证其线程安全。
  * - 若需要彻底结束后台线程，请调用 destory()。
  * - 为避免派生类在析构期间被基类线程调用纯虚函数导致未定义行为，派生类应在析构中
  *   负责先调用 destory() 停止并 join 背景线程。
  */
 class Thread {
 public:
-    Thread();
+    /**
+     * workers: 后台线程数量，至少为 1
+     */
+    explicit Thread(size_t workers = 1);
+
+    /**
+     * 弹性线程数（见 ElasticPolicy）：minWorkers 至少为 1，maxWorkers 不小于 minWorkers；
+     * 监控线程由派生类在构造完成后调用 startElastic() 启动
+     */
+    explicit Thread(const ElasticPolicy &policy);
     virtual ~Thread();
 
     Thread(const Thread &) = delete;
     Thread(Thread &&) = delete;
     Thread &operator=(Thread &&) = delete;
 
+    /**
+     * 返回后台线程数量的上限（弹性线程数时为 maxWorkers），后台线程编号均小于该值
+     */
+    size_t workerCount() const;
+
+    /**
+     * 返回当前正在运行的后台线程数量（弹性线程数时随负载变化）
+     */
+    size_t liveWorkers() const;
+
+    /**
+     * workerIndex() 在当前线程不是本对象的后台线程时的返回值
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * 设置/获取空闲等待策略，可在运行期间随时修改，后台线程在下一次进入空闲时生效
+     */
+    void setIdlePolicy(const IdlePolicy &policy);
+    IdlePolicy idlePolicy() const;
+
+    /**
+     * 后台线程 worker 的空闲等待统计（见 IdleStats）
+     */
+    IdleStats idleStats(size_t worker) const;
+
+    /**
+     * 按 policy 绑定所有后台线程，可在运行期间调用（线程在下一次被调度时迁移）
+     * 全部线程绑定成功返回 true；平台不支持、CoreList 为空或 CPU 编号无效时返回 false，
+     * 此时未成功绑定的线程保持原来的绑定，节点记录为 0
+     */
+    bool setAffinity(const AffinityPolicy &policy);
+
+    /**
+     * 后台线程 worker 所在的 NUMA 节点（未绑定或绑定方式为 None 时为 0）
+     */
+    unsigned workerNode(size_t worker) const;
+
 protected:
     /**
-     * 唤醒后台线程（设置通知标志并通知条件变量）
-     * 派生类在有新任务或需要运行时调用该方法。
+     * 唤醒一个后台线程（增加唤醒次数并通知条件变量）
+     * 派生类在有新任务或需要运行时调用该方法；应在任务对 run() 可见之后调用，以免丢失唤醒。
      */
     void start();
 
     /**
-     * 停止“通知”标志，实际是否停止线程还需配合 destory 来执行线程退出。
+     * 批量唤醒：一次性增加 n 次唤醒（不超过后台线程数），并按阻塞中的线程数通知，
+     * 用于一次提交多个任务的场景，避免逐个任务加锁通知
+     */
+    void start(size_t n);
+
+    /**
+     * 清空待处理的唤醒，实际是否停止线程还需配合 destory 来执行线程退出。
      * stop() 主要用于控制是否继续被唤醒执行 run()，并不能直接终止线程。
      */
     void stop();
 
     /**
-     * 销毁线程：将停止标志置为 false（表示线程应退出），然后唤醒线程并 join。
+     * 销毁线程：将停止标志置为 false（表示线程应退出），然后唤醒所有线程并 join。
      */
     void destory();
 
     /**
-     * 派生类必须实现此方法；后台线程在被唤醒后会调用一次该方法执行工作逻辑。
+     * 启动弹性线程数的监控线程（固定线程数时什么都不做）
+     * 监控线程会调用 backlog()，派生类应在自身构造完成后（构造函数体中）调用；
+     * destory() 会先停止监控线程，之后不再创建新的后台线程
+     */
+    void startElastic();
+
+    /**
+     * 派生类可重载：返回待处理的任务数（近似值即可），弹性线程数据此判断是否积压；默认返回 0（从不增加线程）
+     */
+    virtual size_t backlog();
+
+    /**
+     * 若调用线程是本对象的后台线程，返回其编号 [0, workerCount())；否则返回 npos
+     */
+    size_t workerIndex() const;
+
+    /**
+     * 派生类必须实现此方法；后台线程在每次被唤醒后调用一次该方法，该方法应处理完所有可执行的工作再返回。
      * 该方法不应该在基类或其他线程析构期间被调用（否则可能发生纯虚调用问题）。
      */
     virtual void run() = 0;
 
+    /**
+     * 派生类可重载：返回下一次需要主动调用 run() 的时刻（例如最近的定时任务到期时刻），
+     * 默认返回 time_point::max() 表示没有。后台线程阻塞前查询该值，到期时即使没有唤醒也会调用 run()；
+     * 同一时刻只有持有最早时刻的一个线程做限时阻塞，其余线程照常阻塞。
+     * 该时刻提前（例如登记了更早的定时任务）时，派生类应随后调用 start()，使线程重新查询。
+     */
+    virtual std::chrono::steady_clock::time_point nextWakeup();
+
 private:
+    /**
+     * 在编号 i 的位置创建后台线程（调用方持有线程表的锁）
+     */
+    void launch(size_t i, bool runFirst);
+
+    /**
+     * 监控线程：按 ElasticPolicy 增加后台线程，并回收已退出的线程
+     */
+    void supervise();
+
     class Impl;
     std::unique_ptr<Impl> pImpl;   // PIMPL：隐藏实现细节（condition_variable、thread、atomic）
 };
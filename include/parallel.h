@@ -0,0 +1,202 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include "workqueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * ParallelSplitter - 基于任务队列的递归区间拆分
+ *
+ * Queue 可以是 WorkQueue 或任意 BasicWorkQueue<LockPolicy, QueuePolicy>，只需提供 post() 与 runPendingTask()。
+ *
+ * 将 [0, chunks) 个块递归二分：每次把右半部分 post() 到队列，左半部分继续拆分，
+ * 直到只剩一个块时在当前线程执行 leaf(块编号)。
+ * - 在后台线程中拆分出的右半部分进入该线程的本地双端队列，由空闲线程窃取，天然实现负载均衡
+ * - 发起调用的线程参与执行：自己处理最左侧的块，然后通过 runPendingTask() 帮忙执行其他任务，
+ *   而不是阻塞等待；因此在任务内部嵌套调用也不会占死后台线程
+ * - 任一块抛出异常后，尚未开始的块被跳过，第一个异常在 run() 返回前重新抛出
+ * - 队列没有执行而直接销毁的右半部分（已关闭、Reject / DropOldest 容量策略、关闭时丢弃等）
+ *   在销毁时登记下来，由发起调用的线程自己执行，不会因为等待它们而永远不返回
+ */
+template <typename Queue, typename Leaf>
+class ParallelSplitter {
+public:
+    ParallelSplitter(Queue &q, size_t chunks, Leaf &leaf)
+        : queue(q), leaf(leaf), chunks(chunks), pending(0), failed(false) {}
+
+    void run() {
+        if (chunks == 0)
+            return;
+
+        split(0, chunks);
+        for (;;) {
+            while (pending.load(std::memory_order_acquire) > 0) {
+                if (!queue.runPendingTask())
+                    std::this_thread::yield();
+            }
+
+            std::pair<size_t, size_t> range;
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (dropped.empty())
+                    break;
+                range = dropped.back();
+                dropped.pop_back();
+            }
+            split(range.first, range.second);
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    /**
+     * Half - post() 出去的右半部分；执行或未执行就被销毁时都恰好完成一次 pending 的计数
+     */
+    class Half {
+    public:
+        Half(ParallelSplitter *s, size_t l, size_t h) noexcept : owner(s), lo(l), hi(h) {}
+        Half(Half &&other) noexcept : owner(other.owner), lo(other.lo), hi(other.hi) {
+            other.owner = nullptr;
+        }
+        Half(const Half &) = delete;
+
+        ~Half() {
+            if (!owner)
+                return;
+            {
+                std::lock_guard<std::mutex> lock(owner->errorMutex);
+                owner->dropped.emplace_back(lo, hi);
+            }
+            owner->pending.fetch_sub(1, std::memory_order_release);
+        }
+
+        void operator()() {
+            ParallelSplitter *s = owner;
+            owner = nullptr;
+            s->split(lo, hi);
+            // 最后一步：之后不能再访问 s（调用方可能已经返回）
+            s->pending.fetch_sub(1, std::memory_order_release);
+        }
+
+    private:
+        ParallelSplitter *owner;
+        size_t lo;
+        size_t hi;
+    };
+
+    void split(size_t lo, size_t hi) {
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            pending.fetch_add(1, std::memory_order_relaxed);
+            queue.post(Half(this, mid, hi));
+            hi = mid;
+        }
+
+        if (failed.load(std::memory_order_relaxed))
+            return;
+
+        try {
+            leaf(lo);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = std::current_exception();
+            failed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    Queue &queue;
+    Leaf &leaf;
+    size_t chunks;
+    std::atomic<size_t> pending; // 已 post 但尚未完成的右半部分数量
+    std::atomic<bool> failed;
+    std::mutex errorMutex;       // 保护 error 与 dropped
+    std::exception_ptr error;
+    std::vector<std::pair<size_t, size_t>> dropped; // 被队列丢弃、留给调用线程执行的区间
+};
+
+/**
+ * 自动粒度：让每个后台线程平均分到约 8 个块，兼顾负载均衡与调度开销
+ */
+template <typename Queue>
+size_t autoGrain(const Queue &queue, size_t n) {
+    size_t grain = n / (queue.workerCount() * 8);
+    return grain == 0 ? 1 : grain;
+}
+
+/**
+ * parallelFor - 对 [begin, end) 中的每个下标 i 并行执行 fn(i)
+ *
+ * grain 为每个块的下标数量，传 0 时按后台线程数自动划分。
+ * 调用线程参与执行，全部完成后返回；fn 抛出的第一个异常会在返回前重新抛出。
+ */
+template <typename Queue, typename Index, typename F>
+void parallelFor(Queue &queue, Index begin, Index end, Index grain, F &&fn) {
+    static_assert(std::is_integral<Index>::value, "parallelFor 的下标必须为整数类型");
+    if (end <= begin)
+        return;
+
+    size_t n = static_cast<size_t>(end - begin);
+    size_t g = grain > 0 ? static_cast<size_t>(grain) : autoGrain(queue, n);
+    size_t chunks = (n + g - 1) / g;
+
+    auto leaf = [&](size_t c) {
+        size_t lo = c * g;
+        size_t hi = lo + g < n ? lo + g : n;
+        for (size_t i = lo; i < hi; ++i)
+            fn(static_cast<Index>(begin + static_cast<Index>(i)));
+    };
+
+    ParallelSplitter<Queue, decltype(leaf)>(queue, chunks, leaf).run();
+}
+
+/**
+ * parallelReduce - 对 [begin, end) 并行计算 reduce(...reduce(identity, map(begin))..., map(end - 1))
+ *
+ * - 每个块在本地从 identity 开始累积 map(i)，得到块内部分结果
+ * - 所有块完成后按块的顺序依次合并部分结果，因此 reduce 只需满足结合律，结果与块的执行顺序无关
+ * - identity 需为 reduce 的单位元（如求和为 0），T 需可复制
+ */
+template <typename Queue, typename Index, typename T, typename Map, typename Reduce>
+T parallelReduce(Queue &queue, Index begin, Index end, Index grain, T identity, Map &&map,
+                 Reduce &&reduce) {
+    static_assert(std::is_integral<Index>::value, "parallelReduce 的下标必须为整数类型");
+    if (end <= begin)
+        return identity;
+
+    size_t n = static_cast<size_t>(end - begin);
+    size_t g = grain > 0 ? static_cast<size_t>(grain) : autoGrain(queue, n);
+    size_t chunks = (n + g - 1) / g;
+    std::vector<T> partials(chunks, identity);
+
+    auto leaf = [&](size_t c) {
+        size_t lo = c * g;
+        size_t hi = lo + g < n ? lo + g : n;
+        T acc = identity;
+        for (size_t i = lo; i < hi; ++i)
+            acc = reduce(std::move(acc), map(static_cast<Index>(begin + static_cast<Index>(i))));
+        partials[c] = std::move(acc);
+    };
+
+    ParallelSplitter<Queue, decltype(leaf)>(queue, chunks, leaf).run();
+
+    T result = std::move(identity);
+    for (auto &p : partials)
+        result = reduce(std::move(result), std::move(p));
+    return result;
+}
+}
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef QUEUEFRONTEND_H_
+#define QUEUEFRONTEND_H_
+
+#include "cancel.h"
+#include "coroutine.h"
+#include "future.h"
+#include "task.h"
+#include "timer.h"
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace lmc {
+
+/**
+ * Priority - 任务优先级（延迟等级）
+ * - High: 关键路径上的短任务，后台线程总是优先检查该通道
+ * - Normal: 默认优先级
+ * - Low: 批处理等长任务，通过加权公平保证不会被永久饿死
+ */
+enum class Priority: unsigned char {
+    High,
+    Normal,
+    Low,
+};
+
+#ifdef LMC_HAS_COROUTINES
+/**
+ * ScheduleAwaiter - co_await queue.schedule() 的等待器
+ *
+ * 挂起当前协程并把“恢复该协程”作为一个任务提交到队列，协程随后在执行该任务的后台线程中继续。
+ * 任务被队列丢弃时（队列已关闭、Reject 溢出策略等）协程在丢弃它的线程中恢复，
+ * co_await 抛出 future_error(broken_promise)，协程不会永远挂起。
+ */
+template <typename Queue>
+class ScheduleAwaiter {
+public:
+    ScheduleAwaiter(Queue &q, Priority p) noexcept : queue(q), priority(p), rejected(false) {}
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        queue.submit(Task(Resumer(h, &rejected)), priority, false);
+    }
+
+    void await_resume() const {
+        if (rejected)
+            throw future_error(future_errc::broken_promise);
+    }
+
+private:
+    /**
+     * 执行时恢复协程；未执行就被销毁时标记 rejected 并恢复协程
+     */
+    class Resumer {
+    public:
+        Resumer(std::coroutine_handle<> h, bool *flag) noexcept : handle(h), rejected(flag) {}
+        Resumer(Resumer &&other) noexcept : handle(exchange(other.handle, nullptr)), rejected(other.rejected) {}
+
+        ~Resumer() {
+            if (handle) {
+                *rejected = true;
+                handle.resume();
+            }
+        }
+
+        void operator()() {
+            exchange(handle, nullptr).resume();
+        }
+
+    private:
+        std::coroutine_handle<> handle;
+        bool *rejected;
+    };
+
+    Queue &queue;
+    Priority priority;
+    bool rejected;
+};
+#endif
+
+/**
+ * QueueFrontend - 任务提交接口（CRTP）
+ *
+ * 把各种提交方式（addTask / post / 批量 / 延迟 / 周期）统一转换为 Task，
+ * 再交给派生类的底层接口，派生类 Derived 需提供：
+ * - bool submit(Task &&task, Priority priority, bool tryOnly): 入队并唤醒，返回是否已入队
+ * - void submitBatch(vector<Task> &&tasks): 批量入队并唤醒
+ * - TimerHandle schedule(time_point when, Task &&task, duration period): 登记定时任务
+ * - bool runPendingTask(): 在调用线程中执行一个待处理的任务
+ *
+ * 通过 CRTP 而不是虚函数调用派生类：BasicWorkQueue 的提交路径可以被完全内联。
+ */
+template <typename Derived>
+class QueueFrontend {
+public:
+    /**
+     * 添加任务
+     * 第一个参数为任务函数（可为 lambda、函数指针、可调用对象），后续参数为该函数的参数
+     * 返回 std::future<ReturnType>，用于获取任务最终返回值或等待任务完成
+     *
+     * 逻辑说明：
+     * - 使用 PromiseTask 将可调用对象、参数与 promise 打包，执行时把结果或异常写入 promise
+     * - 参数按值保存（decay），执行时优先以右值传给 f，f 只接受左值时传入保存的副本（见 TaskCall）；
+     *   以这些参数无法调用 f 时在调用处编译失败
+     * - PromiseTask 存放在 Task 中，随 Task 移动，队列独占其生命周期，无需共享指针与引用计数
+     * - 将任务推入队列后唤醒后台线程执行
+     * - 在后台线程中调用时，任务放入该线程的本地双端队列；否则放入全局队列
+     * - 打包任务时的异常（例如分配 promise 共享状态时的 bad_alloc、参数的复制构造）直接抛给调用方
+     */
+    template <typename F, typename ...Args>
+    auto addTask(F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        return addTask(Priority::Normal, forward<F>(f), forward<Args>(args)...);
+    }
+
+    /**
+     * 按指定优先级添加任务，其余同 addTask(f, args...)
+     * 非 Normal 优先级的任务总是放入对应的全局优先级通道（即使在后台线程中提交），
+     * 以便任意空闲线程都能尽快取到
+     */
+    template <typename F, typename ...Args>
+    auto addTask(Priority priority, F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        using returnType = TaskResult<F, Args...>;
+        using bodyType = PromiseTask<returnType, typename decay<F>::type, typename decay<Args>::type...>;
+
+        promise<returnType> p(allocator_arg, PoolAllocator<returnType>());
+        future<returnType> returnRes = p.get_future();
+        self().submit(Task(bodyType(move(p), forward<F>(f), forward<Args>(args)...)), priority, false);
+        return returnRes;
+    }
+
+    /**
+     * 带取消令牌添加任务（见 cancel.h）：任务开始执行前令牌已取消时不调用 f，
+     * future 得到 TaskCancelled；执行期间 CancellationToken::current() 返回该令牌，供 f 协作检查
+     */
+    template <typename F, typename ...Args>
+    auto addTask(const CancellationToken &token, F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        return addTask(Priority::Normal, token, forward<F>(f), forward<Args>(args)...);
+    }
+
+    template <typename F, typename ...Args>
+    auto addTask(Priority priority, const CancellationToken &token, F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        return addTask(priority, cancel::Guarded<typename decay<F>::type>(token, forward<F>(f)),
+                       forward<Args>(args)...);
+    }
+
+    /**
+     * 添加任务并返回支持续延的 Future（见 future.h），其余同 addTask
+     *
+     * Future 的 then(f) 默认把续延提交回本队列，whenAll / whenAny 组合多个 Future；
+     * 多阶段流水线（例如 读取 -> 解析 -> 汇总）以续延串联，任何阶段都不会阻塞线程等待上一阶段。
+     * f 返回 Future<U> 时结果为 Future<U>（等内层完成）。
+     */
+    template <typename F, typename ...Args>
+    auto async(F &&f, Args &&...args) ->
+    Future<typename fut::Unwrap<TaskResult<F, Args...>>::type> {
+        return async(Priority::Normal, forward<F>(f), forward<Args>(args)...);
+    }
+
+    template <typename F, typename ...Args>
+    auto async(Priority priority, F &&f, Args &&...args) ->
+    Future<typename fut::Unwrap<TaskResult<F, Args...>>::type> {
+        using returnType = typename fut::Unwrap<TaskResult<F, Args...>>::type;
+
+        using call = TaskCall<typename decay<F>::type, typename decay<Args>::type...>;
+
+        Promise<returnType> p{Executor(self())};
+        Future<returnType> returnRes = p.getFuture();
+        self().submit(Task([p = move(p), fn = typename decay<F>::type(forward<F>(f)),
+                            params = tuple<typename decay<Args>::type...>(forward<Args>(args)...)]() mutable {
+            fut::fulfil(p, [&] { return call::invoke(fn, params); });
+        }), priority, false);
+        return returnRes;
+    }
+
+    /**
+     * 带取消令牌添加任务并返回 Future：已取消时 Future 得到 TaskCancelled，其余同 addTask(token, f, args...)
+     */
+    template <typename F, typename ...Args>
+    auto async(const CancellationToken &token, F &&f, Args &&...args) ->
+    Future<typename fut::Unwrap<TaskResult<F, Args...>>::type> {
+        return async(Priority::Normal, token, forward<F>(f), forward<Args>(args)...);
+    }
+
+    template <typename F, typename ...Args>
+    auto async(Priority priority, const CancellationToken &token, F &&f, Args &&...args) ->
+    Future<typename fut::Unwrap<TaskResult<F, Args...>>::type> {
+        return async(priority, cancel::Guarded<typename decay<F>::type>(token, forward<F>(f)),
+                     forward<Args>(args)...);
+    }
+
+    /**
+     * 尝试添加任务：全局队列已达到容量上限时不做任何等待，立即返回空的 optional（与溢出策略无关）
+     * 未设置容量上限，或在后台线程中以 Normal 优先级提交时，总是成功
+     */
+    template <typename F, typename ...Args>
+    auto tryAddTask(F &&f, Args &&...args) ->
+    optional<future<TaskResult<F, Args...>>> {
+        return tryAddTask(Priority::Normal, forward<F>(f), forward<Args>(args)...);
+    }
+
+    template <typename F, typename ...Args>
+    auto tryAddTask(Priority priority, F &&f, Args &&...args) ->
+    optional<future<TaskResult<F, Args...>>> {
+        using returnType = TaskResult<F, Args...>;
+        using bodyType = PromiseTask<returnType, typename decay<F>::type, typename decay<Args>::type...>;
+
+        promise<returnType> p(allocator_arg, PoolAllocator<returnType>());
+        future<returnType> returnRes = p.get_future();
+        if (!self().submit(Task(bodyType(move(p), forward<F>(f), forward<Args>(args)...)), priority, true))
+            return nullopt;
+        return optional<future<returnType>>(move(returnRes));
+    }
+
+    /**
+     * 批量添加任务：对 [first, last) 中的每个元素 x 提交任务 fn(x)
+     * 返回与元素一一对应的 future 列表
+     *
+     * 所有任务在一次加锁中放入队列，并只做一次按空闲线程数计算的唤醒，
+     * 适合大批量提交的场景（逐个调用 addTask 每次都要加锁与通知）
+     */
+    template <typename It, typename F>
+    auto addTasks(It first, It last, F fn) ->
+    vector<future<TaskResult<F, typename iterator_traits<It>::reference>>> {
+        using returnType = TaskResult<F, typename iterator_traits<It>::reference>;
+        using valueType = typename decay<typename iterator_traits<It>::reference>::type;
+        using bodyType = PromiseTask<returnType, F, valueType>;
+
+        vector<future<returnType>> results;
+        vector<Task> tasks;
+        reserveFor(results, tasks, first, last, typename iterator_traits<It>::iterator_category());
+
+        for (; first != last; ++first) {
+            promise<returnType> p(allocator_arg, PoolAllocator<returnType>());
+            results.push_back(p.get_future());
+            tasks.emplace_back(bodyType(move(p), fn, *first));
+        }
+
+        self().submitBatch(move(tasks));
+        return results;
+    }
+
+    /**
+     * 提交一个无需返回值的任务（fire-and-forget）
+     *
+     * 与 addTask 不同，不创建 promise/future：可调用对象直接放入 Task，
+     * 小的 lambda 提交时不做任何堆分配。任务抛出的异常交给 setExceptionHandler() 设置的处理函数。
+     */
+    template <typename F>
+    void post(F &&f) {
+        self().submit(Task(forward<F>(f)), Priority::Normal, false);
+    }
+
+    template <typename F>
+    void post(Priority priority, F &&f) {
+        self().submit(Task(forward<F>(f)), priority, false);
+    }
+
+    /**
+     * 带取消令牌提交无需返回值的任务：开始执行前令牌已取消时直接跳过（不调用异常处理函数）
+     */
+    template <typename F>
+    void post(const CancellationToken &token, F &&f) {
+        post(Priority::Normal, token, forward<F>(f));
+    }
+
+    template <typename F>
+    void post(Priority priority, const CancellationToken &token, F &&f) {
+        self().submit(Task(cancel::Skippable<typename decay<F>::type>(token, forward<F>(f))), priority, false);
+    }
+
+    /**
+     * 尝试提交无需返回值的任务，全局队列已满时立即返回 false（见 tryAddTask）
+     */
+    template <typename F>
+    bool tryPost(F &&f) {
+        return tryPost(Priority::Normal, forward<F>(f));
+    }
+
+    template <typename F>
+    bool tryPost(Priority priority, F &&f) {
+        return self().submit(Task(forward<F>(f)), priority, true);
+    }
+
+    /**
+     * 延迟任务：在 delay 之后（不早于）执行 f(args...)，返回 std::future
+     *
+     * 定时器登记进分层时间轮，登记与取消均为 O(1)，精度为 1ms；到期后作为 Normal 优先级任务执行。
+     * 队列析构时尚未到期的任务被丢弃，对应的 future 得到 broken_promise。
+     */
+    template <typename Rep, typename Period, typename F, typename ...Args>
+    auto addTaskAfter(const chrono::duration<Rep, Period> &delay, F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        return addTaskAt(chrono::steady_clock::now() + chrono::ceil<chrono::steady_clock::duration>(delay),
+                         forward<F>(f), forward<Args>(args)...);
+    }
+
+    /**
+     * 定时任务：在 when 时刻（不早于）执行 f(args...)，其余同 addTaskAfter
+     */
+    template <typename F, typename ...Args>
+    auto addTaskAt(const chrono::steady_clock::time_point &when, F &&f, Args &&...args) ->
+    future<TaskResult<F, Args...>> {
+        using returnType = TaskResult<F, Args...>;
+        using bodyType = PromiseTask<returnType, typename decay<F>::type, typename decay<Args>::type...>;
+
+        promise<returnType> p(allocator_arg, PoolAllocator<returnType>());
+        future<returnType> returnRes = p.get_future();
+        self().schedule(when, Task(bodyType(move(p), forward<F>(f), forward<Args>(args)...)),
+                        chrono::steady_clock::duration::zero());
+        return returnRes;
+    }
+
+    /**
+     * 可取消的延迟任务（fire-and-forget）：在 delay 之后执行 f，返回 TimerHandle，
+     * 典型用途是超时：正常完成时调用 cancel() 撤销超时处理，撤销后任务在锁外被销毁。
+     * 异常处理同 post()。
+     */
+    template <typename Rep, typename Period, typename F>
+    TimerHandle postAfter(const chrono::duration<Rep, Period> &delay, F &&f) {
+        return postAt(chrono::steady_clock::now() + chrono::ceil<chrono::steady_clock::duration>(delay),
+                      forward<F>(f));
+    }
+
+    template <typename F>
+    TimerHandle postAt(const chrono::steady_clock::time_point &when, F &&f) {
+        return self().schedule(when, Task(forward<F>(f)), chrono::steady_clock::duration::zero());
+    }
+
+    /**
+     * 周期任务：从 interval 之后开始，每隔 interval 执行一次 f(args...)，直到通过返回的句柄取消
+     *
+     * - 同一个周期任务不会并发执行：上一次执行结束后才按 “上次到期时刻 + interval” 重新登记，
+     *   执行耗时超过 interval 时不会补执行错过的次数，而是在结束后立即执行下一次
+     * - 每次执行时以左值形式传入参数的副本
+     * - 抛出的异常交给 setExceptionHandler() 设置的处理函数，不影响后续执行
+     */
+    template <typename Rep, typename Period, typename F, typename ...Args>
+    TimerHandle addPeriodic(const chrono::duration<Rep, Period> &interval, F &&f, Args &&...args) {
+        auto period = chrono::ceil<chrono::steady_clock::duration>(interval);
+        if (period <= chrono::steady_clock::duration::zero())
+            period = chrono::steady_clock::duration(1);
+
+        auto body = [fn = typename decay<F>::type(forward<F>(f)),
+                     params = make_tuple(forward<Args>(args)...)]() mutable {
+            apply(fn, params);
+        };
+        return self().schedule(chrono::steady_clock::now() + period, Task(move(body)), period);
+    }
+
+#ifdef LMC_HAS_COROUTINES
+    /**
+     * co_await queue.schedule(): 在本队列的后台线程中恢复当前协程（C++20，见 ScheduleAwaiter）
+     * 在后台线程中以 Normal 优先级调用时进入该线程的本地队列，与 post() 相同
+     */
+    ScheduleAwaiter<Derived> schedule(Priority priority = Priority::Normal) noexcept {
+        return ScheduleAwaiter<Derived>(self(), priority);
+    }
+#endif
+
+    /**
+     * 等待 future 就绪；等待期间在调用线程中执行本队列中其他待处理的任务（帮忙执行），
+     * 没有可执行的任务时短暂阻塞后再检查。
+     *
+     * 在本队列的任务内部等待本队列的另一个任务时应使用该方法而不是 future::get()：
+     * 单线程队列中直接 get() 会死锁，多线程队列中会白白占用一个后台线程。
+     * 适用于 std::future、std::shared_future 与 Future。
+     */
+    template <typename Waitable>
+    void wait(const Waitable &f) {
+        while (f.wait_for(chrono::seconds(0)) != future_status::ready) {
+            if (!self().runPendingTask())
+                f.wait_for(chrono::microseconds(50));
+        }
+    }
+
+    /**
+     * 以帮忙执行的方式等待并取出 future 的结果（见 wait()）
+     */
+    template <typename T>
+    T get(future<T> &f) {
+        wait(f);
+        return f.get();
+    }
+
+    template <typename T>
+    T get(future<T> &&f) {
+        wait(f);
+        return f.get();
+    }
+
+    template <typename T>
+    T get(Future<T> &f) {
+        wait(f);
+        return f.get();
+    }
+
+    template <typename T>
+    T get(Future<T> &&f) {
+        wait(f);
+        return f.get();
+    }
+
+protected:
+    QueueFrontend() = default;
+    ~QueueFrontend() = default;
+
+private:
+    Derived &self() {
+        return static_cast<Derived &>(*this);
+    }
+
+    /**
+     * 前向迭代器可预先得知元素个数，预留空间避免多次扩容
+     */
+    template <typename R, typename It>
+    static void reserveFor(vector<future<R>> &results, vector<Task> &tasks, It first, It last,
+                           forward_iterator_tag) {
+        auto n = static_cast<size_t>(distance(first, last));
+        results.reserve(n);
+        tasks.reserve(n);
+    }
+
+    template <typename R, typename It>
+    static void reserveFor(vector<future<R>> &, vector<Task> &, It, It, input_iterator_tag) {}
+};
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+#include "src/util/histogram.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * WorkerStats - 一个后台线程的累计统计
+ * - executed: 执行的任务数
+ * - steals: 从其他线程的本地队列窃取成功的次数
+ * - spinWakeups / yieldWakeups / parks: 空闲等待的统计（见 IdleStats）
+ */
+struct WorkerStats {
+    uint64_t executed = 0;
+    uint64_t steals = 0;
+    uint64_t spinWakeups = 0;
+    uint64_t yieldWakeups = 0;
+    uint64_t parks = 0;
+};
+
+/**
+ * WorkQueueStats - 工作队列统计快照（见 WorkQueue::stats()）
+ *
+ * 只有 queuedGlobal / queuedLocal 总是有效；其余字段仅在编译时定义 LMC_ENABLE_STATS
+ * （CMake 选项 LMC_ENABLE_STATS）时记录，否则为 0，此时 enabled 为 false，
+ * 提交与执行路径上没有任何统计开销。
+ *
+ * - queuedGlobal: 全局（各优先级通道）队列中的任务数（近似）
+ * - queuedLocal: 所有本地双端队列中的任务数（近似）
+ * - liveWorkers: 当前正在运行的后台线程数（弹性线程数时随负载变化），workers 按上限排列
+ * - lockContentions: 加锁时锁已被占用的次数（只有加锁的队列策略会记录）
+ * - externalExecuted: 在非后台线程中执行的任务数（帮忙执行、CallerRuns），不计入直方图
+ * - waitTime: 任务从入队到开始执行的延迟（纳秒），所有后台线程合并
+ * - runTime: 任务执行耗时（纳秒），所有后台线程合并
+ */
+struct WorkQueueStats {
+    bool enabled = false;
+    size_t queuedGlobal = 0;
+    size_t queuedLocal = 0;
+    size_t liveWorkers = 0;
+    uint64_t lockContentions = 0;
+    uint64_t externalExecuted = 0;
+    std::vector<WorkerStats> workers;
+    HistogramSnapshot waitTime;
+    HistogramSnapshot runTime;
+};
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef STRAND_H_
+#define STRAND_H_
+
+#include "queuefrontend.h"
+#include "task.h"
+#include "timer.h"
+#include "src/util/cpupause.hpp"
+#include "src/util/mpscqueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * Strand - 挂在共享执行器上的逻辑串行队列
+ *
+ * 每个 WorkQueue 都独占自己的后台线程；按子系统各建一个队列会产生大量几乎空闲的线程。
+ * Strand 本身没有线程：多个 Strand 共用同一个多线程的 WorkQueue / BasicWorkQueue（执行器），
+ * 由执行器的固定线程集合轮流执行：
+ * - 同一 Strand 的任务按提交顺序逐个执行，任意时刻至多一个在执行（任务之间无需加锁），
+ *   前一个任务的效果（包括析构）对后一个任务可见
+ * - 不同 Strand 的任务在执行器的不同线程上并行执行
+ * - 提交接口与 WorkQueue 相同（addTask / post / async / 延迟与周期任务 / co_await schedule() 等），
+ *   Future 的 then() 默认把续延提交回本 Strand
+ *
+ * 实现：
+ * - 任务放入无锁的 MPSC 队列，另以原子计数记录待执行的任务数；计数从 0 变为 1 的提交者
+ *   在执行器中登记“调度任务”，因此任意时刻至多一个调度任务，提交与交接都不加锁
+ * - 调度任务在同一个线程中连续执行至多 batch 个任务（数据留在该线程的缓存中），
+ *   计数归零即结束；用完配额仍有任务时重新提交自身：在后台线程中以 Normal 优先级提交时
+ *   进入该线程的本地队列，通常由同一线程继续执行，队列中的其他 Strand 也能轮到，繁忙的 Strand 不会饿死它们
+ *
+ * 约束与说明：
+ * - 执行器必须比 Strand 及其所有任务活得更久；Strand 析构时不等待，已提交的任务照常执行
+ * - 优先级只决定调度任务进入执行器的哪个通道（取触发调度的那次提交的优先级），Strand 内部始终按提交顺序执行
+ * - Strand 自身不限容量，tryAddTask / tryPost 总是成功；执行器关闭后调度任务被丢弃，
+ *   此时 Strand 中待执行的任务一并丢弃（addTask 的 future 得到 broken_promise）
+ * - 抛出的异常交给执行器的 setExceptionHandler() 设置的处理函数，不影响后续任务
+ * - 在 Strand 的任务中不能等待同一 Strand 中之后提交的任务（串行执行，必然死锁）
+ */
+template <typename Queue>
+class Strand final : public QueueFrontend<Strand<Queue>> {
+public:
+    static constexpr size_t DefaultBatch = 32;
+
+    /**
+     * batch: 调度任务每次连续执行的最大任务数（至少为 1）；越大局部性越好，越小 Strand 之间越公平
+     */
+    explicit Strand(Queue &executor, size_t batch = DefaultBatch)
+        : state(std::make_shared<State>(executor, batch == 0 ? 1 : batch)) {}
+
+    Strand(const Strand &) = delete;
+    Strand &operator=(const Strand &) = delete;
+
+    /**
+     * 底层提交接口：追加到 Strand 队尾，Strand 空闲时向执行器提交调度任务
+     */
+    bool submit(Task &&task, Priority priority, bool tryOnly = false) {
+        (void)tryOnly;
+        return State::push(state, std::move(task), priority);
+    }
+
+    /**
+     * 批量提交：全部入队后只更新一次计数，至多提交一个调度任务
+     */
+    void submitBatch(std::vector<Task> &&tasks) {
+        if (tasks.empty())
+            return;
+        for (Task &t : tasks)
+            state->tasks.push(std::move(t));
+        size_t n = tasks.size();
+        tasks.clear();
+        if (state->pending.fetch_add(n, std::memory_order_acq_rel) == 0)
+            state->executor.submit(Task(Drainer(state, Priority::Normal)), Priority::Normal, false);
+    }
+
+    /**
+     * 定时任务登记在执行器的定时器中，到期时把任务追加到本 Strand；
+     * 周期任务每次到期追加一次，同一周期任务的各次执行同样按顺序串行
+     */
+    TimerHandle schedule(std::chrono::steady_clock::time_point when, Task &&task,
+                         std::chrono::steady_clock::duration period) {
+        if (period == std::chrono::steady_clock::duration::zero()) {
+            return state->executor.schedule(when, Task([s = state, t = std::move(task)]() mutable {
+                State::push(s, std::move(t), Priority::Normal);
+            }), period);
+        }
+
+        auto body = std::make_shared<Task>(std::move(task));
+        return state->executor.schedule(when, Task([s = state, body] {
+            State::push(s, Task([body] { (*body)(); }), Priority::Normal);
+        }), period);
+    }
+
+#ifdef LMC_HAS_COROUTINES
+    using QueueFrontend<Strand<Queue>>::schedule;   // co_await strand.schedule()
+#endif
+
+    /**
+     * 帮忙执行：在调用线程中执行执行器中的一个待处理任务（可能属于其他 Strand）
+     */
+    bool runPendingTask() {
+        return state->executor.runPendingTask();
+    }
+
+    Queue &executor() const noexcept {
+        return state->executor;
+    }
+
+private:
+    class Drainer;
+
+    /**
+     * State - Strand 的共享状态：调度任务持有其引用计数，Strand 先于任务析构也是安全的
+     *
+     * pending 统计已入队、尚未执行完的任务数：入队在前、计数在后，
+     * 因此持有调度权的一方看到 pending > 0 时队列中一定有（可能正在链接的）元素；
+     * 计数归零的 release 与下一个提交者从 0 开始计数的 acquire 配对，前后两个调度任务之间建立先后关系。
+     */
+    struct State {
+        State(Queue &q, size_t b) : executor(q), batch(b), pending(0) {}
+
+        static bool push(const std::shared_ptr<State> &s, Task &&task, Priority priority) {
+            s->tasks.push(std::move(task));
+            if (s->pending.fetch_add(1, std::memory_order_acq_rel) != 0)
+                return true;
+            return s->executor.submit(Task(Drainer(s, priority)), priority, false);
+        }
+
+        /**
+         * 连续执行至多 batch 个任务；每个任务（连同其捕获的对象）销毁之后才开始下一个，异常照常传给执行器
+         */
+        static void drain(const std::shared_ptr<State> &s, Priority priority) {
+            for (size_t ran = 1;; ++ran) {
+                Task f = s->take();
+                try {
+                    f();
+                } catch (...) {
+                    f = nullptr;
+                    if (s->finish())
+                        s->executor.submit(Task(Drainer(s, priority)), priority, false);
+                    throw;
+                }
+                f = nullptr;
+                if (!s->finish())
+                    return;
+                if (ran == s->batch) {
+                    s->executor.submit(Task(Drainer(s, priority)), priority, false);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * 取出队首任务（仅由持有调度权的一方调用，此时 pending > 0）
+         */
+        Task take() {
+            Task f;
+            while (!tasks.pop(f))
+                cpuPause();
+            return f;
+        }
+
+        /**
+         * 完成一个任务，返回是否还有待执行的任务；返回 false 时交出调度权
+         */
+        bool finish() {
+            return pending.fetch_sub(1, std::memory_order_acq_rel) != 1;
+        }
+
+        /**
+         * 调度任务被执行器丢弃：丢弃所有待执行的任务并交出调度权，之后的提交重新尝试调度
+         */
+        void abandon() {
+            do {
+                take();
+            } while (finish());
+        }
+
+        Queue &executor;
+        const size_t batch;
+        MpscQueue<Task> tasks;         // 待执行的任务，按入队顺序
+        std::atomic<size_t> pending;   // 已入队、尚未执行完（或丢弃）的任务数
+    };
+
+    /**
+     * Drainer - 提交给执行器的调度任务；未执行就被销毁时放弃 Strand 中的任务
+     */
+    class Drainer {
+    public:
+        Drainer(std::shared_ptr<State> s, Priority p) noexcept : state(std::move(s)), priority(p) {}
+        Drainer(Drainer &&) noexcept = default;
+
+        ~Drainer() {
+            if (state)
+                state->abandon();
+        }
+
+        void operator()() {
+            std::shared_ptr<State> s = std::move(state);
+            State::drain(s, priority);
+        }
+
+    private:
+        std::shared_ptr<State> state;
+        Priority priority;
+    };
+
+    std::shared_ptr<State> state;
+};
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef TASK_H_
+#define TASK_H_
+
+#include "src/util/poolalloc.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 统计与跟踪都需要任务的入队时刻，任一开启时 Task 携带该字段
+ */
+#if defined(LMC_ENABLE_STATS) || defined(LMC_ENABLE_TRACE)
+#define LMC_TASK_ENQUEUE_TIME 1
+#endif
+
+namespace lmc {
+
+/**
+ * Task - 只可移动的无参任务对象（小对象优化）
+ *
+ * 与 std::function<void()> 的区别：
+ * - 只要求可调用对象可移动（因此可以直接持有 std::promise 等只可移动的对象）
+ * - 内联存储 InlineSize 字节，尺寸不超过该值且移动构造不抛异常的可调用对象不做任何堆分配；
+ *   更大的可调用对象才会退化为堆存储，其内存来自线程缓存的内存池（poolAllocate），稳态下不调用 malloc
+ * - 整个 Task 对象恰好占用一个缓存行（64 字节）；定义 LMC_ENABLE_STATS 或 LMC_ENABLE_TRACE 时额外携带入队时刻（72 字节）
+ *
+ * 类型擦除通过静态的函数表（VTable）实现：每种可调用对象类型对应一张表，
+ * Task 只保存指向该表的指针，调用/移动/析构均为一次间接调用。
+ */
+class Task {
+public:
+    static constexpr std::size_t InlineSize = 64 - sizeof(void *);
+
+    Task() noexcept : vtable(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<
+                  !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F &&f) : vtable(&VTableFor<typename std::decay<F>::type>::table) {
+        VTableFor<typename std::decay<F>::type>::create(storage, std::forward<F>(f));
+    }
+
+    Task(Task &&other) noexcept : vtable(other.vtable) {
+#ifdef LMC_TASK_ENQUEUE_TIME
+        enqueuedAt = other.enqueuedAt;
+#endif
+        if (vtable) {
+            vtable->move(storage, other.storage);
+            other.vtable = nullptr;
+        }
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            reset();
+            vtable = other.vtable;
+#ifdef LMC_TASK_ENQUEUE_TIME
+            enqueuedAt = other.enqueuedAt;
+#endif
+            if (vtable) {
+                vtable->move(storage, other.storage);
+                other.vtable = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~Task() {
+        reset();
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    explicit operator bool() const noexcept {
+        return vtable != nullptr;
+    }
+
+    /**
+     * 执行任务（调用前必须确保 Task 非空）
+     */
+    void operator()() {
+        vtable->invoke(storage);
+    }
+
+#ifdef LMC_TASK_ENQUEUE_TIME
+    /**
+     * 统计与跟踪用：入队时刻（steady_clock 的计数），0 表示未记录
+     */
+    void setEnqueueTime(int64_t t) noexcept {
+        enqueuedAt = t;
+    }
+
+    int64_t enqueueTime() const noexcept {
+        return enqueuedAt;
+    }
+#endif
+
+    /**
+     * 可调用对象 F 是否会被内联存储（不发生堆分配）
+     */
+    template <typename F>
+    static constexpr bool storedInline() {
+        return sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+private:
+    struct VTable {
+        void (*invoke)(void *self);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *self) noexcept;
+    };
+
+    /**
+     * 内联存储：可调用对象直接构造在 storage 中
+     */
+    template <typename F, bool Inline = storedInline<F>()>
+    struct VTableFor {
+        template <typename G>
+        static void create(void *where, G &&g) {
+            new (where) F(std::forward<G>(g));
+        }
+        static void invoke(void *self) {
+            (*static_cast<F *>(self))();
+        }
+        static void move(void *dst, void *src) noexcept {
+            new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        }
+        static void destroy(void *self) noexcept {
+            static_cast<F *>(self)->~F();
+        }
+        static constexpr VTable table = {&invoke, &move, &destroy};
+    };
+
+    /**
+     * 堆存储：storage 中只保存指向堆上可调用对象的指针，内存来自 PoolAllocator
+     */
+    template <typename F>
+    struct VTableFor<F, false> {
+        template <typename G>
+        static void create(void *where, G &&g) {
+            PoolAllocator<F> alloc;
+            F *p = alloc.allocate(1);
+            try {
+                new (p) F(std::forward<G>(g));
+            } catch (...) {
+                alloc.deallocate(p, 1);
+                throw;
+            }
+            *static_cast<F **>(where) = p;
+        }
+        static void invoke(void *self) {
+            (**static_cast<F **>(self))();
+        }
+        static void move(void *dst, void *src) noexcept {
+            *static_cast<F **>(dst) = *static_cast<F **>(src);
+        }
+        static void destroy(void *self) noexcept {
+            F *p = *static_cast<F **>(self);
+            p->~F();
+            PoolAllocator<F>().deallocate(p, 1);
+        }
+        static constexpr VTable table = {&invoke, &move, &destroy};
+    };
+
+    void reset() noexcept {
+        if (vtable) {
+            vtable->destroy(storage);
+            vtable = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[InlineSize];
+    const VTable *vtable;
+#ifdef LMC_TASK_ENQUEUE_TIME
+    int64_t enqueuedAt = 0;
+#endif
+};
+
+/**
+ * TaskCall - 任务执行时如何调用保存的 f(args...)（F、Args 为按值保存的类型）
+ *
+ * - 任务只执行一次，f 接受右值时与 std::async 一致，以右值传递保存的可调用对象与参数
+ *   （支持 unique_ptr 等只可移动的参数）
+ * - f 只接受左值（例如 [](int &x) { ... } 或不可移动调用的可调用对象）时退回以左值调用，
+ *   与原先基于 std::bind 的行为一致；f 得到的是队列中保存的副本，而不是调用方的变量
+ * - 两种方式都无法调用时没有 type 成员：TaskResult 替换失败，addTask 等接口在调用处报错
+ */
+template <bool ByRvalue, bool ByLvalue, typename F, typename ...Args>
+struct TaskCallImpl {};
+
+template <bool ByLvalue, typename F, typename ...Args>
+struct TaskCallImpl<true, ByLvalue, F, Args...> {
+    using type = std::invoke_result_t<F, Args...>;
+
+    static type invoke(F &fn, std::tuple<Args...> &args) {
+        return std::apply(std::move(fn), std::move(args));
+    }
+};
+
+template <typename F, typename ...Args>
+struct TaskCallImpl<false, true, F, Args...> {
+    using type = std::invoke_result_t<F &, Args &...>;
+
+    static type invoke(F &fn, std::tuple<Args...> &args) {
+        return std::apply(fn, args);
+    }
+};
+
+template <typename F, typename ...Args>
+struct TaskCall : TaskCallImpl<std::is_invocable<F, Args...>::value, std::is_invocable<F &, Args &...>::value,
+                               F, Args...> {};
+
+/**
+ * addTask(f, args...) 等接口的返回类型：按 TaskCall 实际调用的方式计算
+ */
+template <typename F, typename ...Args>
+using TaskResult = typename TaskCall<typename std::decay<F>::type, typename std::decay<Args>::type...>::type;
+
+/**
+ * PromiseTask - 直接基于 std::promise 的任务体
+ *
+ * 持有 promise、可调用对象与参数，执行时调用 f(args...) 并把返回值或异常写入 promise。
+ * 调用方式见 TaskCall：优先以右值传给 f，f 只接受左值时以左值传入保存的副本。
+ * 若任务在执行前被销毁，promise 析构时会向对应的 future 报告 broken_promise。
+ * 与 packaged_task + shared_ptr + std::function 相比，只剩 promise 自身的共享状态分配，
+ * 且没有额外的引用计数原子操作；WorkQueue 以 PoolAllocator 构造 promise，共享状态同样来自内存池。
+ */
+template <typename R, typename F, typename ...Args>
+class PromiseTask {
+public:
+    template <typename G, typename ...A>
+    PromiseTask(std::promise<R> &&p, G &&g, A &&...a)
+        : promise(std::move(p)), fn(std::forward<G>(g)), args(std::forward<A>(a)...) {}
+
+    PromiseTask(PromiseTask &&) = default;
+
+    void operator()() {
+        try {
+            fulfil(std::is_void<R>());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+private:
+    void fulfil(std::false_type) {
+        promise.set_value(TaskCall<F, Args...>::invoke(fn, args));
+    }
+
+    void fulfil(std::true_type) {
+        TaskCall<F, Args...>::invoke(fn, args);
+        promise.set_value();
+    }
+
+    std::promise<R> promise;
+    F fn;
+    std::tuple<Args...> args;
+};
+}
+
+#endif
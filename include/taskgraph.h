@@ -0,0 +1,164 @@
+#ifndef TASKGRAPH_H_
+#define TASKGRAPH_H_
+
+#include "future.h"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * TaskGraph - 有向无环的任务依赖图
+ *
+ * add() 添加节点，precede(a, b) 声明 b 依赖 a（a 完成后 b 才能开始），run(queue) 把图提交到队列执行：
+ * - 没有前驱的节点立即提交；每个节点完成时递减后继的剩余前驱数，变为 0 的后继随即就绪，
+ *   其中一个在当前线程中直接执行（数据仍在缓存中），其余提交到队列——任何线程都不会阻塞等待依赖
+ * - 任一节点抛出异常后，尚未开始的节点被跳过，run() 返回的 Future 以第一个异常完成
+ * - 同一个图可以多次 run()，但必须等上一次的 Future 完成；运行期间图不能被修改或销毁
+ *
+ * Queue 可以是 WorkQueue 或任意 BasicWorkQueue，只需提供 post()。
+ */
+class TaskGraph {
+public:
+    using Node = size_t;
+
+    /**
+     * 添加节点，返回其编号；f 可能被多次 run() 重复调用，因此以 std::function 保存
+     */
+    template <typename F>
+    Node add(F &&f) {
+        nodes.push_back(NodeData{std::function<void()>(std::forward<F>(f)), {}, 0});
+        return nodes.size() - 1;
+    }
+
+    /**
+     * 声明 after 依赖 before
+     */
+    void precede(Node before, Node after) {
+        if (before >= nodes.size() || after >= nodes.size() || before == after)
+            throw std::invalid_argument("TaskGraph::precede: invalid node");
+        nodes[before].successors.push_back(after);
+        ++nodes[after].predecessors;
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    /**
+     * 提交整张图，返回所有节点完成（或第一个异常）时就绪的 Future；
+     * 图中存在环时抛出 std::invalid_argument，不执行任何节点
+     */
+    template <typename Queue>
+    Future<void> run(Queue &queue) {
+        checkAcyclic();
+
+        auto s = std::make_shared<RunState>(*this, Executor(queue));
+        Future<void> done = s->done.getFuture();
+        if (nodes.empty()) {
+            s->done.setValue();
+            return done;
+        }
+
+        for (Node n = 0; n < nodes.size(); ++n)
+            if (nodes[n].predecessors == 0)
+                s->executor.post(Task([s, n] { execute(s, n); }));
+        return done;
+    }
+
+private:
+    struct NodeData {
+        std::function<void()> fn;
+        std::vector<Node> successors;
+        size_t predecessors;
+    };
+
+    /**
+     * RunState - 一次 run() 的状态，由所有已提交的节点任务共享
+     */
+    struct RunState {
+        RunState(const TaskGraph &g, Executor e)
+            : graph(g), executor(e), pending(new std::atomic<size_t>[g.nodes.size()]),
+              remaining(g.nodes.size()), failed(false), done(e) {
+            for (size_t i = 0; i < g.nodes.size(); ++i)
+                pending[i].store(g.nodes[i].predecessors, std::memory_order_relaxed);
+        }
+
+        const TaskGraph &graph;
+        Executor executor;
+        std::unique_ptr<std::atomic<size_t>[]> pending;   // 每个节点尚未完成的前驱数
+        std::atomic<size_t> remaining;                     // 尚未完成的节点数
+        std::atomic<bool> failed;
+        std::exception_ptr error;                          // 只由第一个失败的节点写入
+        Promise<void> done;
+    };
+
+    static void execute(const std::shared_ptr<RunState> &s, Node n) {
+        const auto &nodes = s->graph.nodes;
+        for (;;) {
+            if (!s->failed.load(std::memory_order_relaxed)) {
+                try {
+                    nodes[n].fn();
+                } catch (...) {
+                    if (!s->failed.exchange(true, std::memory_order_acq_rel))
+                        s->error = std::current_exception();
+                }
+            }
+
+            // 就绪的后继：最后一个留给当前线程继续执行，其余提交到队列
+            Node next = static_cast<Node>(-1);
+            for (Node succ : nodes[n].successors) {
+                if (s->pending[succ].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    continue;
+                if (next != static_cast<Node>(-1))
+                    s->executor.post(Task([s, next] { execute(s, next); }));
+                next = succ;
+            }
+
+            if (s->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                if (s->error)
+                    s->done.setException(s->error);
+                else
+                    s->done.setValue();
+                return;
+            }
+            if (next == static_cast<Node>(-1))
+                return;
+            n = next;
+        }
+    }
+
+    void checkAcyclic() const {
+        std::vector<size_t> indegree(nodes.size());
+        std::vector<Node> ready;
+        for (Node n = 0; n < nodes.size(); ++n) {
+            indegree[n] = nodes[n].predecessors;
+            if (indegree[n] == 0)
+                ready.push_back(n);
+        }
+
+        size_t visited = 0;
+        while (!ready.empty()) {
+            Node n = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (Node succ : nodes[n].successors)
+                if (--indegree[succ] == 0)
+                    ready.push_back(succ);
+        }
+        if (visited != nodes.size())
+            throw std::invalid_argument("TaskGraph::run: graph contains a cycle");
+    }
+
+    std::vector<NodeData> nodes;
+};
+}
+
+#endif
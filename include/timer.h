@@ -0,0 +1,134 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include "task.h"
+#include "src/util/timerwheel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * TimerNode - 一个已登记的定时任务
+ *
+ * - task: 到期时执行的任务；一次性定时器到期后被移出执行，周期定时器每次到期都会调用一次
+ * - deadline: 本次到期时刻
+ * - period: 周期，0 表示一次性定时器
+ * - cancelled: 已被取消（受 TimerService 的互斥体保护）
+ * - self: 节点在定时轮中时持有自身的引用，保证定时轮中的裸指针有效；移出定时轮时释放
+ */
+struct TimerNode : TimerWheelNode {
+    Task task;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::duration period{0};
+    bool cancelled = false;
+    std::shared_ptr<TimerNode> self;
+};
+
+/**
+ * TimerService - 基于分层时间轮的定时器集合（线程安全）
+ *
+ * 不拥有任何线程：由 WorkQueue 的后台线程在空闲等待前查询 nextDeadline()，
+ * 并在 run() 中调用 collect() 取出到期的定时器后自行执行。
+ * 登记、取消均为 O(1)；tick 精度为 1ms，定时器不会早于 deadline 到期。
+ */
+class TimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TimerService();
+    ~TimerService();
+
+    TimerService(const TimerService &) = delete;
+    TimerService &operator=(const TimerService &) = delete;
+
+    /**
+     * 登记定时任务，返回对应节点；若 when 已到期，节点不进入定时轮，dueNow 被置为 true，
+     * 由调用者立即执行
+     */
+    std::shared_ptr<TimerNode> arm(Clock::time_point when, Task &&task, Clock::duration period,
+                                   bool &dueNow);
+
+    /**
+     * 周期定时器开始执行一次之前调用：已被取消（包括到期后排队等待执行期间被取消）时返回 false，不应再执行
+     */
+    bool beginRun(const std::shared_ptr<TimerNode> &node);
+
+    /**
+     * 周期定时器执行完一次后重新登记；已被取消时返回 false，到期时刻已过时返回 false 并置 dueNow
+     */
+    bool rearm(const std::shared_ptr<TimerNode> &node, Clock::time_point when, bool &dueNow);
+
+    /**
+     * 取消定时器；成功阻止了（下一次）执行时返回 true
+     */
+    bool cancel(const std::shared_ptr<TimerNode> &node);
+
+    /**
+     * 推进到 now 并取出所有到期的节点；其他线程正在推进时直接返回（由其负责处理）
+     */
+    void collect(Clock::time_point now, std::vector<std::shared_ptr<TimerNode>> &due);
+
+    /**
+     * 下一次需要处理定时器的时刻，没有定时器时返回 Clock::time_point::max()（无锁）
+     */
+    Clock::time_point nextDeadline() const;
+
+    /**
+     * 是否有已登记的定时器（无锁，近似值）
+     */
+    bool empty() const {
+        return count.load(std::memory_order_acquire) == 0;
+    }
+
+    /**
+     * 移除并丢弃所有定时器（一次性定时器对应的 future 会得到 broken_promise）
+     */
+    void clear();
+
+    /**
+     * clear() 并关闭：之后 arm() 登记的定时器直接丢弃，正在执行的周期定时器 rearm() 返回 false 且不置 dueNow，
+     * 排队中或正在执行的周期任务执行完当前这一次后不再继续
+     */
+    void close();
+
+private:
+    uint64_t toTick(Clock::time_point t) const;
+    void updateNextDeadline();
+
+    std::mutex m;
+    TimerWheel wheel;
+    Clock::time_point epoch;           // tick 0 对应的时刻
+    std::atomic<int64_t> nextDueTick;  // 下一次需要处理的 tick，INT64_MAX 表示没有
+    std::atomic<size_t> count;         // 定时轮中的节点数
+    bool closed = false;               // 已 close()（受 m 保护）
+};
+
+/**
+ * TimerHandle - 定时任务句柄
+ *
+ * 只持有弱引用：定时器执行完毕或 WorkQueue 析构后，cancel() 安全地返回 false。
+ */
+class TimerHandle {
+public:
+    TimerHandle() = default;
+    TimerHandle(std::weak_ptr<TimerService> service, std::weak_ptr<TimerNode> node)
+        : service(std::move(service)), node(std::move(node)) {}
+
+    /**
+     * 取消定时任务：一次性定时器在到期前取消时返回 true；周期定时器取消后不再执行，返回 true
+     */
+    bool cancel();
+
+private:
+    std::weak_ptr<TimerService> service;
+    std::weak_ptr<TimerNode> node;
+};
+}
+
+#endif
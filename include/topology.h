@@ -0,0 +1,52 @@
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * CpuTopology - 本机逻辑 CPU 的拓扑
+ *
+ * - cpus: 所有在线的逻辑 CPU，按编号升序；core 为所在物理核编号（同一 package 内唯一），
+ *   package 为所在物理 CPU（插槽）编号，node 为所在 NUMA 节点编号
+ * - nodeCount: NUMA 节点数（至少为 1）
+ *
+ * Linux 下从 /sys/devices/system 读取；其他平台或读取失败时按
+ * hardware_concurrency() 个逻辑 CPU、每个逻辑 CPU 一个物理核、单个 NUMA 节点处理。
+ */
+struct CpuTopology {
+    struct Cpu {
+        unsigned id;
+        unsigned core;
+        unsigned package;
+        unsigned node;
+    };
+
+    std::vector<Cpu> cpus;
+    size_t nodeCount = 1;
+
+    /**
+     * 每个物理核取一个逻辑 CPU（编号最小的超线程），按 NUMA 节点、编号排序
+     */
+    std::vector<unsigned> physicalCores() const;
+
+    /**
+     * NUMA 节点 node 上的所有逻辑 CPU
+     */
+    std::vector<unsigned> nodeCpus(unsigned node) const;
+
+    /**
+     * 逻辑 CPU id 所在的 NUMA 节点，未知的 CPU 返回 0
+     */
+    unsigned nodeOf(unsigned id) const;
+};
+
+/**
+ * 探测本机拓扑（结果在首次调用时缓存，线程安全）
+ */
+const CpuTopology &cpuTopology();
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * 只开启跟踪时 x86 上以 TSC 计时（一次读取约为 steady_clock 的四分之一），导出时按 steady_clock 校准；
+ * 同时开启统计时统一使用 steady_clock，使任务的入队时刻对两者通用
+ */
+#if !defined(LMC_ENABLE_STATS) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define LMC_TRACE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace lmc {
+
+/**
+ * 任务跟踪：记录任务的入队/开始/结束时刻、窃取、空闲阻塞与全局通道锁的等待，导出为
+ * Chrome trace-event JSON（chrome://tracing、ui.perfetto.dev 均可直接打开）
+ *
+ * - 埋点只在编译时定义 LMC_ENABLE_TRACE（CMake 选项 LMC_ENABLE_TRACE）时存在，否则没有任何开销，
+ *   导出的跟踪为空
+ * - 编译进来之后默认不记录，enable() 之后才记录；关闭时每个埋点只有一次 relaxed 原子读取
+ * - 每个线程写入自己的固定容量环形缓冲区（BufferEvents 个事件，写满后覆盖最旧的事件），
+ *   写入不加锁、不分配内存，每个任务只有几次普通存储与三次时钟读取（入队、开始、结束）；线程第一次记录时登记缓冲区
+ * - dump() 可在任意线程随时调用，导出每个线程最近的事件，不阻塞正在记录的线程
+ *
+ * 事件：
+ * - task: 任务在后台线程（或帮忙执行的线程）上的执行区间，args 中 wait_us 为入队到开始的等待时间
+ * - steal: 从其他后台线程的本地队列窃取到任务，args 中 victim 为被窃取线程的编号
+ * - park: 后台线程阻塞在条件变量上的区间（自旋与让出阶段不计）
+ * - lock wait: 全局通道锁已被占用时等待加锁的区间
+ */
+namespace trace {
+
+static constexpr size_t BufferEvents = 16384;
+
+enum class Event : uint8_t {
+    Task,
+    Steal,
+    Park,
+    LockWait,
+};
+
+namespace detail {
+extern std::atomic<bool> on;
+
+void record(Event e, int64_t start, int64_t duration, uint64_t arg) noexcept;
+}
+
+/**
+ * 开始 / 停止记录（任意线程，立即生效）
+ */
+void enable(bool on = true) noexcept;
+
+inline void disable() noexcept {
+    enable(false);
+}
+
+/**
+ * 是否正在记录：埋点以此决定是否读取时钟
+ */
+inline bool active() noexcept {
+    return detail::on.load(std::memory_order_relaxed);
+}
+
+/**
+ * 跟踪使用的时钟：TSC 计数或 steady_clock 的计数（见 LMC_TRACE_TSC），只用于求差与导出
+ */
+inline int64_t now() noexcept {
+#ifdef LMC_TRACE_TSC
+    return static_cast<int64_t>(__rdtsc());
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+inline void record(Event e, int64_t start, int64_t duration, uint64_t arg = 0) noexcept {
+    detail::record(e, start, duration, arg);
+}
+
+/**
+ * 当前线程在跟踪中显示的名称（后台线程启动时自动设置为 "lmc worker N"）
+ */
+void setThreadName(const std::string &name);
+
+/**
+ * 丢弃所有已记录的事件
+ */
+void clear();
+
+/**
+ * 以 Chrome trace-event JSON 格式导出所有线程最近的事件；写入文件失败时返回 false
+ */
+void dump(std::ostream &out);
+bool dump(const std::string &path);
+}
+}
+
+#endif
@@ -1,14 +1,21 @@
 #ifndef WORKQUEUE_H_
 #define WORKQUEUE_H_
 
-#include "lthread.h"
+#include "basicworkqueue.h"
+#include "src/util/cacheline.hpp"
 #include "src/util/spinmutex.hpp"
+#include "src/util/ticketmutex.hpp"
+#include "src/util/mcsmutex.hpp"
 
-#include <future>
-#include <iostream>
+#include <exception>
 #include <functional>
-#include <queue>
+#include <iostream>
 #include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstddef>
 
 using namespace std;
 
@@ -16,14 +23,20 @@ namespace lmc {
 
 /**
  * MutexType - 支持的互斥策略
- * - None: 不做任何互斥（由使用者保证安全）
- * - Spin: 使用自旋锁（SpinMutex）
+ * - None: 单生产者单消费者：全局队列为无等待的 SPSC 环形队列，只允许一个外部线程提交，固定 1 个后台线程
+ * - Spin: 使用自旋锁（SpinMutex，TTAS + 指数退避）
  * - Mutex: 使用 std::mutex
+ * - LockFree: 不使用锁，全局队列改为有界无锁环形队列（MpmcQueue），多个生产者可无锁提交
+ * - Ticket: 使用排号自旋锁（TicketMutex），先到先得，争用时不会饿死某个提交者
+ * - Mcs: 使用 MCS 队列锁（McsMutex），每个等待者只在自己的节点上自旋，适合大量线程同时争用
  */
 enum class MutexType: unsigned char {
     None,
     Spin,
     Mutex,
+    LockFree,
+    Ticket,
+    Mcs,
 };
 
 /**
@@ -32,7 +45,12 @@ enum class MutexType: unsigned char {
  * 根据设置的 MutexType 决定 lock()/unlock() 的实现：
  * - 在 MutexType::Mutex 时使用 std::mutex，适合线程间阻塞等待场景
  * - 在 MutexType::Spin 时使用自旋锁，适合短临界区、频繁争用且对延迟敏感的场景
+ * - 在 MutexType::Ticket / MutexType::Mcs 时使用公平的排号锁 / 队列锁（见 MutexType）
  * - 在 MutexType::None 时不进行互斥（由调用者保证并发安全）
+ * - 在 MutexType::LockFree 时不进行互斥（全局队列本身是无锁的）
+ *
+ * WorkQueue 已改为按 MutexType 选择编译期的锁策略（见 BasicWorkQueue），内部不再使用 SMutex；
+ * 保留该类供需要在运行期切换锁类型的使用者。
  */
 class SMutex {
 public:
@@ -42,28 +60,51 @@ public:
     void setMutexType(MutexType m);
 
 private:
-    SpinMutex mSpinMutex;
-    mutex mMutex;
+    // 互斥类型每次加锁都要读取，锁字被争用者反复写入：二者分属不同缓存行
     MutexType mMutexType;
+    SpinMutex mSpinMutex;                  // 各自旋锁自身独占缓存行
+    TicketMutex mTicketMutex;
+    McsMutex mMcsMutex;
+    alignas(CacheLineSize) mutex mMutex;
 };
 
 /**
- * WorkQueue - 基于 Thread 的任务队列实现
+ * WorkQueue - 在运行期按 MutexType 选择策略的任务队列（BasicWorkQueue 的兼容封装）
  *
  * 功能：
  * - 提供模板方法 addTask，将任意可调用对象封装成任务并返回 std::future
  * - 任务被放入内部队列，并唤醒后台线程（基类 Thread）去执行任务
+ * - 支持多个后台线程共同消费同一个任务队列（线程池模式）
+ * - 每个后台线程拥有一个工作窃取双端队列：在任务内部提交的子任务放入本线程的本地队列，
+ *   空闲线程从其他线程的本地队列窃取任务，递归分治类任务无需每次都争用全局队列的锁
  * - 支持通过 MutexType 选择不同的互斥策略
+ * - 支持延迟任务与周期任务：定时器登记在分层时间轮中，由后台线程自行检查并执行到期的定时器，
+ *   不需要额外的定时线程
  *
  * 设计要点：
- * - addTask 将函数与参数绑定到 packaged_task，使用 shared_ptr 管理生命周期，
- *   将任务包装为无参的 std::function<void()> 放入队列
- * - run() 在后台线程中被调用一次，负责从队列取出并执行一个任务
- * - 析构函数在清空队列后会调用 destory() 停止并 join 基类线程，避免纯虚函数在析构时被调用
+ * - 构造时按 MutexType 创建对应的 BasicWorkQueue<LockPolicy, QueuePolicy>（见 basicworkqueue.h），
+ *   此后每次提交只有一次虚函数调用，队列内部的加锁与入队都按所选策略内联，没有按类型的分支
+ * - 策略在编译期已知时直接使用 BasicWorkQueue，提交路径没有任何间接调用
+ * - addTask 将函数、参数与 std::promise 一起放入只可移动的 Task（小对象内联存储），
+ *   提交一个小的 lambda 时 Task 本身不做堆分配；较大的任务体、promise 共享状态与本地队列节点
+ *   均来自线程缓存的内存池（PoolAllocator），稳态提交不经过全局 malloc
+ * - MutexType::None 的全局队列为 SPSC 环形队列：只允许一个外部线程提交，固定只有 1 个后台线程；
+ *   任务内部提交的任务全部进入后台线程的本地队列
+ * - MutexType::LockFree 的全局队列为预分配的有界环形队列，入队不分配节点；队列满时提交者让出 CPU 并重试
  */
-class WorkQueue final : public Thread {
+class WorkQueue final : public QueueFrontend<WorkQueue> {
 public:
-    WorkQueue(MutexType m);
+    /**
+     * m: 队列互斥策略
+     * workers: 后台线程数量，默认为硬件并发数；MutexType::None 时忽略该参数，固定为 1
+     */
+    WorkQueue(MutexType m, size_t workers = thread::hardware_concurrency());
+
+    /**
+     * 弹性线程数：后台线程数在 [minWorkers, maxWorkers] 之间按负载增减（见 ElasticPolicy）；
+     * MutexType::None 时忽略该参数，固定为 1
+     */
+    WorkQueue(MutexType m, const ElasticPolicy &policy);
     ~WorkQueue();
 
     WorkQueue(const WorkQueue &) = delete;
@@ -71,51 +112,102 @@ public:
     WorkQueue &operator=(WorkQueue &&) = delete;
 
     /**
-     * 添加任务
-     * 第一个参数为任务函数（可为 lambda、函数指针、可调用对象），后续参数为该函数的参数
-     * 返回 std::future<ReturnType>，用于获取任务最终返回值或等待任务完成
+     * 底层提交接口（addTask/post 等最终调用），见 BasicWorkQueue::submit
+     */
+    bool submit(Task &&task, Priority priority, bool tryOnly = false);
+
+    /**
+     * 批量提交已构造好的任务：一次加锁入队，一次唤醒（唤醒数为 min(任务数, 后台线程数)）
+     */
+    void submitBatch(vector<Task> &&tasks);
+
+    /**
+     * 登记定时任务，见 BasicWorkQueue::schedule
+     */
+    TimerHandle schedule(chrono::steady_clock::time_point when, Task &&task,
+                         chrono::steady_clock::duration period);
+
+#ifdef LMC_HAS_COROUTINES
+    using QueueFrontend<WorkQueue>::schedule;   // co_await queue.schedule()
+#endif
+
+    /**
+     * 在调用线程中取出并执行一个待处理的任务，没有可执行的任务时返回 false
      *
-     * 逻辑说明：
-     * - 使用 std::packaged_task 将可调用对象包装为可获取 future 的形式
-     * - 将任务推入队列后调用 start() 唤醒后台线程执行 run()
-     * - 使用共享指针管理 packaged_task 的生命周期，确保队列中的可调用对象在执行期间有效
-     */
-    template <typename F, typename ...Args>
-    auto addTask(F &&f, Args &&...args) throw() ->
-    future<typename result_of<F(Args...)>::type> {
-        using returnType = typename result_of<F(Args...)>::type;
-        auto task = make_shared<packaged_task<returnType()>>(bind(
-                                forward<F>(f), forward<Args>(args)...));
-        future<returnType> returnRes = task.get()->get_future();
-
-        // 对队列进行互斥保护（由 SMutex 根据类型决定具体实现）
-        mutex.lock();
-        workqueue.emplace([task]{(*task)();});
-        mutex.unlock();
-
-        // 唤醒后台线程执行任务
-        start();
-        return returnRes;
-    }
+     * 用于等待方“帮忙执行”：等待其他任务完成的线程可以循环调用该方法，而不是阻塞空等。
+     * MutexType::None 的全局队列不允许第二个消费者，此时外部线程调用只会窃取本地队列中的任务。
+     */
+    bool runPendingTask();
+
+    /**
+     * 返回后台线程数量的上限 / 当前正在运行的后台线程数量（见 Thread::workerCount / liveWorkers）
+     */
+    size_t workerCount() const;
+    size_t liveWorkers() const;
+
+    /**
+     * 设置/获取后台线程的空闲等待策略（见 IdlePolicy）
+     */
+    void setIdlePolicy(const IdlePolicy &policy);
+    IdlePolicy idlePolicy() const;
+
+    /**
+     * 按 policy 绑定后台线程的 CPU / NUMA 节点，见 Thread::setAffinity
+     */
+    bool setAffinity(const AffinityPolicy &policy);
+
+    /**
+     * 后台线程 worker 所在的 NUMA 节点，见 Thread::workerNode
+     */
+    unsigned workerNode(size_t worker) const;
+
+    /**
+     * 设置全局队列的容量上限与溢出策略，见 WorkQueueBase::setCapacity
+     */
+    void setCapacity(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+
+    /**
+     * 因溢出策略被丢弃的任务总数
+     */
+    size_t droppedTasks() const;
+
+    /**
+     * 设置 post() 提交的任务抛出异常时的处理函数（在执行该任务的后台线程中调用）
+     * 传入空函数恢复默认行为：将异常信息输出到 std::cerr。处理函数本身不应再抛出异常。
+     */
+    void setExceptionHandler(function<void(exception_ptr)> handler);
 
     /**
      * 显式停止工作队列的唤醒（不等同于销毁线程）
      */
     void stopWorkQueue();
 
-protected:
+    using Mode = ShutdownMode;
+
     /**
-     * run() - 后台线程每次被唤醒后调用该函数
-     *
-     * 实现逻辑：
-     * - 加锁检查队列是否为空；若为空则直接返回（不消费任务）
-     * - 否则弹出队首任务并在解锁后执行，避免长时间持锁阻塞其他提交者
+     * 关闭队列并停止所有后台线程，见 BasicWorkQueue::shutdown；析构时未调用过则以 Mode::Drain 关闭
+     */
+    bool shutdown(Mode mode = Mode::Drain,
+                  chrono::steady_clock::duration timeout = chrono::steady_clock::duration::max());
+
+    /**
+     * 是否已开始关闭
+     */
+    bool isShutdown() const;
+
+    /**
+     * 统计快照，见 WorkQueueStats；编译时未定义 LMC_ENABLE_STATS 时只有队列深度有效
      */
-    void run() override;
+    WorkQueueStats stats() const;
 
 private:
-    queue<function<void()>> workqueue; // 任务队列
-    SMutex mutex;                      // 可切换的互斥体
+    class Impl;
+    template <typename LockPolicy, typename QueuePolicy>
+    class ImplFor;
+
+    static unique_ptr<Impl> makeImpl(MutexType m, const ElasticPolicy &workers);
+
+    unique_ptr<Impl> pImpl;   // 按 MutexType 选定的 BasicWorkQueue
 };
 }
 
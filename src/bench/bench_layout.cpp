@@ -0,0 +1,122 @@
+#include "workqueue.h"
+#include "src/util/cacheline.hpp"
+#include "src/util/cpupause.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace lmc;
+using namespace std;
+
+/**
+ * 伪共享微基准
+ *
+ * 对比同一组被多线程访问的字段“紧挨着存放”与“按缓存行隔离”两种布局的耗时，
+ * 两种访问模式分别对应本库中的典型场景：
+ * - 写-写：提交者 CAS nNotify、后台线程登记 nParked（Thread::Impl）
+ * - 锁-读：争用者反复写 SpinMutex 的标志、其他线程每次加锁前读取互斥类型（SMutex）
+ * 最后给出多生产者提交空任务的吞吐，作为整体参考。
+ *
+ * 注意：只有一个 CPU 核时线程不会真正并行，两种布局的差异无法体现。
+ */
+
+static const size_t ITERATIONS = 20000000;
+
+struct Packed {
+    atomic<size_t> a{0};
+    atomic<size_t> b{0};
+};
+
+struct Padded {
+    alignas(CacheLineSize) atomic<size_t> a{0};
+    alignas(CacheLineSize) atomic<size_t> b{0};
+};
+
+/**
+ * 两个线程各自写自己的字段
+ */
+template <typename Layout>
+static double writeWrite() {
+    Layout l;
+    auto begin = chrono::steady_clock::now();
+    thread t1([&] {
+        for (size_t i = 0; i < ITERATIONS; ++i)
+            l.a.fetch_add(1, memory_order_relaxed);
+    });
+    thread t2([&] {
+        for (size_t i = 0; i < ITERATIONS; ++i)
+            l.b.fetch_add(1, memory_order_relaxed);
+    });
+    t1.join();
+    t2.join();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * 锁字与只读字段（对应 SpinMutex 标志与 SMutex 的互斥类型）
+ */
+struct LockPacked {
+    atomic<bool> flag{false};
+    atomic<unsigned> type{1};
+};
+
+struct LockPadded {
+    alignas(CacheLineSize) atomic<bool> flag{false};
+    alignas(CacheLineSize) atomic<unsigned> type{1};
+};
+
+/**
+ * 一个线程反复加锁/解锁，另一个线程反复读取紧邻的只读字段
+ */
+template <typename Layout>
+static double lockRead() {
+    Layout l;
+    atomic<bool> done{false};
+    atomic<size_t> sink{0};
+    thread reader([&] {
+        size_t sum = 0;
+        while (!done.load(memory_order_relaxed))
+            sum += l.type.load(memory_order_relaxed);
+        sink = sum;
+    });
+
+    auto begin = chrono::steady_clock::now();
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        while (l.flag.exchange(true, memory_order_acquire))
+            cpuPause();
+        l.flag.store(false, memory_order_release);
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    done = true;
+    reader.join();
+    return ms;
+}
+
+static double submitThroughput(size_t producers, size_t perProducer) {
+    WorkQueue q(MutexType::Mutex, 2);
+    atomic<size_t> count{0};
+    auto begin = chrono::steady_clock::now();
+    vector<thread> ts;
+    for (size_t p = 0; p < producers; ++p)
+        ts.emplace_back([&] {
+            for (size_t i = 0; i < perProducer; ++i)
+                q.post([&count] { count.fetch_add(1, memory_order_relaxed); });
+        });
+    for (auto &t : ts)
+        t.join();
+    while (count.load() < producers * perProducer)
+        this_thread::yield();
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    return static_cast<double>(producers * perProducer) / sec;
+}
+
+int main() {
+    printf("缓存行大小: %zu 字节, 硬件线程数: %u\n", CacheLineSize, thread::hardware_concurrency());
+    printf("写-写  紧挨: %8.1f ms   隔离: %8.1f ms\n", writeWrite<Packed>(), writeWrite<Padded>());
+    printf("锁-读  紧挨: %8.1f ms   隔离: %8.1f ms\n", lockRead<LockPacked>(), lockRead<LockPadded>());
+    printf("WorkQueue 4 个生产者提交吞吐: %.0f 任务/秒\n", submitThroughput(4, 500000));
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "workqueue.h"
+#include "basicworkqueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lmc;
+using namespace std;
+
+/**
+ * WorkQueue 基准
+ *
+ * 对每种 MutexType（以及直接使用 BasicWorkQueue<SpinMutex> 的无间接调用版本）扫描
+ * 生产者数量 x 后台线程数量 x 任务耗时（空任务、1us、100us），每组配置输出一行：
+ * - tasks_per_sec: 从第一个任务提交到最后一个任务完成的吞吐
+ * - p50/p99/p999_ns: 每个任务从提交到执行完毕的延迟
+ *
+ * 输出为 CSV（默认）或每行一个 JSON 对象（--json），便于与历史结果比较。
+ * --quick 将每组的任务数缩小为 1/10，用于快速冒烟。
+ * MutexType::None 只允许一个提交线程、固定 1 个后台线程，只运行对应的配置。
+ *
+ * 注意：后台线程数与生产者数之和超过 CPU 核数时，结果主要反映调度而不是队列本身。
+ */
+
+struct Config {
+    const char *backend;
+    size_t producers;
+    size_t workers;
+    unsigned taskUs;
+    size_t tasks;
+};
+
+struct Result {
+    double tasksPerSec;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+};
+
+static int64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * 忙等模拟 CPU 密集的任务（sleep 的精度远不到微秒级）
+ */
+static void spinFor(int64_t ns) {
+    if (ns <= 0)
+        return;
+    int64_t end = nowNs() + ns;
+    while (nowNs() < end) {}
+}
+
+/**
+ * Queue 需提供 post()：WorkQueue 或任意 BasicWorkQueue
+ */
+template <typename Queue>
+static Result runOnce(Queue &queue, const Config &cfg) {
+    const size_t n = cfg.tasks;
+    const int64_t work = static_cast<int64_t>(cfg.taskUs) * 1000;
+    vector<uint64_t> latency(n);
+    atomic<size_t> done(0);
+    atomic<bool> go(false);
+
+    vector<thread> producers;
+    producers.reserve(cfg.producers);
+    for (size_t p = 0; p < cfg.producers; ++p) {
+        producers.emplace_back([&, p] {
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            for (size_t i = p; i < n; i += cfg.producers) {
+                uint64_t *slot = &latency[i];
+                int64_t submitted = nowNs();
+                queue.post([slot, submitted, work, &done] {
+                    spinFor(work);
+                    *slot = static_cast<uint64_t>(nowNs() - submitted);
+                    done.fetch_add(1, memory_order_release);
+                });
+            }
+        });
+    }
+
+    int64_t begin = nowNs();
+    go.store(true, memory_order_release);
+    for (auto &t : producers)
+        t.join();
+    while (done.load(memory_order_acquire) < n)
+        this_thread::yield();
+    int64_t elapsed = nowNs() - begin;
+
+    sort(latency.begin(), latency.end());
+    auto at = [&](double q) {
+        size_t i = static_cast<size_t>(q * static_cast<double>(n));
+        return latency[i < n ? i : n - 1];
+    };
+
+    Result r;
+    r.tasksPerSec = static_cast<double>(n) * 1e9 / static_cast<double>(elapsed > 0 ? elapsed : 1);
+    r.p50 = at(0.50);
+    r.p99 = at(0.99);
+    r.p999 = at(0.999);
+    return r;
+}
+
+static void report(const Config &cfg, const Result &r, bool json) {
+    if (json) {
+        printf("{\"backend\":\"%s\",\"producers\":%zu,\"workers\":%zu,\"task_us\":%u,\"tasks\":%zu,"
+               "\"tasks_per_sec\":%.0f,\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu}\n",
+               cfg.backend, cfg.producers, cfg.workers, cfg.taskUs, cfg.tasks, r.tasksPerSec,
+               static_cast<unsigned long long>(r.p50), static_cast<unsigned long long>(r.p99),
+               static_cast<unsigned long long>(r.p999));
+    } else {
+        printf("%s,%zu,%zu,%u,%zu,%.0f,%llu,%llu,%llu\n", cfg.backend, cfg.producers, cfg.workers,
+               cfg.taskUs, cfg.tasks, r.tasksPerSec, static_cast<unsigned long long>(r.p50),
+               static_cast<unsigned long long>(r.p99), static_cast<unsigned long long>(r.p999));
+    }
+    fflush(stdout);
+}
+
+/**
+ * 任务越长每组的任务数越少，使每组配置的耗时大致相当
+ */
+static size_t tasksFor(unsigned taskUs, bool quick) {
+    size_t n = taskUs == 0 ? 200000 : (taskUs <= 1 ? 50000 : 2000);
+    return quick ? n / 10 : n;
+}
+
+int main(int argc, char **argv) {
+    bool json = false;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else {
+            fprintf(stderr, "用法: %s [--json] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct Backend {
+        const char *name;
+        MutexType type;
+        bool basic; // 直接使用 BasicWorkQueue<SpinMutex>，对比 WorkQueue 封装的虚函数开销
+    };
+    const Backend backends[] = {
+        {"none", MutexType::None, false},
+        {"spin", MutexType::Spin, false},
+        {"mutex", MutexType::Mutex, false},
+        {"lockfree", MutexType::LockFree, false},
+        {"ticket", MutexType::Ticket, false},
+        {"mcs", MutexType::Mcs, false},
+        {"basic-spin", MutexType::Spin, true},
+    };
+    const size_t producerCounts[] = {1, 2, 4};
+    const size_t workerCounts[] = {1, 2, 4};
+    const unsigned taskSizes[] = {0, 1, 100};
+
+    if (!json)
+        printf("backend,producers,workers,task_us,tasks,tasks_per_sec,p50_ns,p99_ns,p999_ns\n");
+
+    for (const Backend &b : backends) {
+        for (size_t producers : producerCounts) {
+            for (size_t workers : workerCounts) {
+                // SPSC：只有一个提交线程，后台线程固定为 1 个
+                if (b.type == MutexType::None && (producers != 1 || workers != 1))
+                    continue;
+
+                for (unsigned us : taskSizes) {
+                    Config cfg{b.name, producers, workers, us, tasksFor(us, quick)};
+                    Result r;
+                    if (b.basic) {
+                        BasicWorkQueue<SpinMutex> queue(workers);
+                        r = runOnce(queue, cfg);
+                    } else {
+                        WorkQueue queue(b.type, workers);
+                        r = runOnce(queue, cfg);
+                    }
+                    report(cfg, r, json);
+                }
+            }
+        }
+    }
+    return 0;
+}
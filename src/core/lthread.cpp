@@ -1,91 +1,561 @@
 #include "lthread.h"
+#include "topology.h"
+#include "trace.h"
+#include "src/util/cacheline.hpp"
+#include "src/util/cpupause.hpp"
+#include "src/util/poolalloc.hpp"
 
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <thread>
 #include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
 
 #define SIZE (10000)
 
 using namespace lmc;
 using namespace std;
 
+/**
+ * 当前线程所属的 Thread 对象及其编号，仅在后台线程中被设置
+ */
+static thread_local const Thread *tlsOwner = nullptr;
+static thread_local size_t tlsIndex = Thread::npos;
+
+/**
+ * 把线程 t 绑定到逻辑 CPU 集合 cpus，平台不支持或失败时返回 false
+ */
+static bool pinThread(std::thread &t, const vector<unsigned> &cpus) {
+    if (cpus.empty() || !t.joinable())
+        return false;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(t.native_handle(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (unsigned cpu : cpus) {
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+            return false;
+        mask |= DWORD_PTR(1) << cpu;
+    }
+    return SetThreadAffinityMask(static_cast<HANDLE>(t.native_handle()), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * 第 i 个后台线程（共 n 个）按 policy 应绑定的逻辑 CPU；None 返回所有在线 CPU（解除绑定）
+ */
+static vector<unsigned> affinityCpus(const AffinityPolicy &policy, size_t i, size_t n) {
+    const CpuTopology &topo = cpuTopology();
+    vector<unsigned> cpus;
+    switch (policy.mode) {
+    case AffinityMode::None:
+        for (auto &c : topo.cpus)
+            cpus.push_back(c.id);
+        break;
+    case AffinityMode::CoreList:
+        if (!policy.cpus.empty())
+            cpus.push_back(policy.cpus[i % policy.cpus.size()]);
+        break;
+    case AffinityMode::PhysicalCores: {
+        vector<unsigned> cores = topo.physicalCores();
+        cpus.push_back(cores[i % cores.size()]);
+        break;
+    }
+    case AffinityMode::NumaNodes: {
+        // 只在有 CPU 的节点之间分组：第 i 个线程属于第 i * 节点数 / 线程数 个节点
+        vector<unsigned> nodes;
+        for (unsigned k = 0; k < topo.nodeCount; ++k)
+            if (!topo.nodeCpus(k).empty())
+                nodes.push_back(k);
+        cpus = topo.nodeCpus(nodes[i * nodes.size() / n]);
+        break;
+    }
+    }
+    return cpus;
+}
+
 /**
  * Thread::Impl - PIMPL 实现细节
  *
  * 成员说明：
+ * - m: 与条件变量配合的互斥体，所有后台线程共享；线程阻塞前在其保护下登记 nParked 并检查唤醒
  * - c: 用于线程等待与唤醒的条件变量
- * - bNotify: 通知标志，防止虚假唤醒；只有为 true 时，条件变量等待才会结束并执行 run()
+ * - nNotify: 待处理的唤醒次数（最多为后台线程数），防止虚假唤醒与唤醒丢失；
+ *            为 0 时后台线程进入空闲等待，每次唤醒消耗一次
+ * - nParked: 当前阻塞在条件变量上的线程数；为 0 时 start() 无需加锁和 notify
  * - bStop: 控制线程是否应继续运行；当 bStop 被置为 false 时，线程退出
- * - t: 实际运行的 std::thread
+ * - timedDeadline: 正在做限时阻塞的线程所等待的时刻（steady_clock 计数），没有时为 INT64_MAX
+ * - spinCount/yieldCount/adaptive: 空闲等待策略（见 IdlePolicy）
+ * - t: 实际运行的 std::thread 集合（每个工作线程一个）
+ * - node: 每个工作线程所在的 NUMA 节点（见 setAffinity），线程每次被唤醒后同步给内存池
+ * - minWorkers/keepAlive/growAfter/backlogThreshold: 弹性线程数配置（见 ElasticPolicy），构造后只读
+ * - live: 正在运行的后台线程数；slot: 每个位置的状态（Empty / Running / Exited）
+ * - slotMutex: 保护 t 中线程对象的创建、join 与 affinity；supervisor 为弹性线程数的监控线程
+ *
+ * 布局：按写入方划分为只读配置、nNotify、nParked、m/c 四组，各自独占缓存行，
+ * 避免提交者的 CAS 与后台线程的阻塞登记互相使对方的缓存行失效（伪共享）。
  */
 class Thread::Impl {
 public:
+    /**
+     * 尝试消耗一次唤醒（无锁），成功返回 true
+     */
+    bool tryConsume() {
+        size_t n = nNotify.load();
+        while (n > 0) {
+            if (nNotify.compare_exchange_weak(n, n - 1))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * 空闲等待：按 自旋 -> 让出 -> 阻塞 的顺序等待一次唤醒
+     * spinLimit 为本线程当前的自旋次数（自适应模式下会被调整）
+     * owner 非空且 owner->nextWakeup() 不为 max 时，阻塞阶段最迟在该时刻返回（视为一次唤醒）；
+     * 首次调用 run() 之前 owner 为空：派生类可能尚未构造完成，不能调用其虚函数
+     * retireable 为 true 时阻塞超过 keepAlive 仍没有唤醒则退出（弹性线程数回收多余线程）
+     * 返回 false 表示线程应退出
+     */
+    bool idleWait(Thread *owner, unsigned &spinLimit, bool retireable) {
+        unsigned limit = spinCount.load(memory_order_relaxed);
+        unsigned yields = yieldCount.load(memory_order_relaxed);
+        unsigned spins = limit;
+        if (adaptive.load(memory_order_relaxed)) {
+            // 自适应下限为 spinCount 的 1/16，保证始终保留少量自旋以感知任务到达频率
+            unsigned floor = limit == 0 ? 0 : limit / 16 + 1;
+            spinLimit = spinLimit < floor ? floor : (spinLimit > limit ? limit : spinLimit);
+            spins = spinLimit;
+        }
+
+        for (unsigned i = 0; i < spins + yields; ++i) {
+            if (!bStop.load())
+                return false;
+            if (tryConsume()) {
+#ifdef LMC_ENABLE_STATS
+                bump(i < spins ? idle[tlsIndex].spinWakeups : idle[tlsIndex].yieldWakeups);
+#endif
+                // 在主动等待阶段等到了任务：说明任务到达频繁，加大自旋次数
+                spinLimit = spinLimit * 2 > limit ? limit : spinLimit * 2;
+                return true;
+            }
+            if (i < spins)
+                cpuPause();
+            else
+                this_thread::yield();
+        }
+
+        // 主动等待阶段没有等到任务：任务稀疏，减少下一次的自旋次数
+        spinLimit /= 2;
+
+        // 只有比当前限时线程更早的时刻才需要再做一次限时阻塞，避免所有空闲线程同时超时醒来
+        auto deadline = owner ? owner->nextWakeup() : chrono::steady_clock::time_point::max();
+        int64_t ticks = deadline == chrono::steady_clock::time_point::max()
+                        ? INT64_MAX : deadline.time_since_epoch().count();
+        int64_t cur = timedDeadline.load();
+        bool timed = false;
+        while (ticks < cur) {
+            if (timedDeadline.compare_exchange_weak(cur, ticks)) {
+                timed = true;
+                break;
+            }
+        }
+
+#ifdef LMC_ENABLE_STATS
+        bump(idle[tlsIndex].parks);
+#endif
+        // 持有限时角色的线程不退出，否则没有线程负责最近的定时任务
+        auto retireAt = retireable && !timed ? chrono::steady_clock::now() + keepAlive
+                                             : chrono::steady_clock::time_point::max();
+        bool retire = false;
+
+#ifdef LMC_ENABLE_TRACE
+        int64_t parkedAt = trace::active() ? trace::now() : 0;
+#endif
+        unique_lock<mutex> lock(m);
+        ++nParked;
+        while (bStop.load() && !tryConsume()) {
+            if (timed) {
+                if (c.wait_until(lock, deadline) == cv_status::timeout)
+                    break;
+            } else if (retireAt != chrono::steady_clock::time_point::max()) {
+                // 超时后在锁内再检查一次唤醒：start() 可能刚增加了唤醒次数，但已无法通知到本线程
+                if (c.wait_until(lock, retireAt) == cv_status::timeout) {
+                    retire = !tryConsume();
+                    break;
+                }
+            } else {
+                c.wait(lock);
+            }
+        }
+        --nParked;
+        lock.unlock();
+#ifdef LMC_ENABLE_TRACE
+        if (parkedAt != 0)
+            trace::record(trace::Event::Park, parkedAt, trace::now() - parkedAt);
+#endif
+
+        // 交还限时角色：若期间已被更早的时刻取代，则由新的限时线程负责
+        if (timed)
+            timedDeadline.compare_exchange_strong(ticks, INT64_MAX);
+        return bStop.load() && !retire;
+    }
+
+    /**
+     * 按当前的 affinity 绑定第 i 个后台线程并记录其节点（调用方持有 slotMutex）
+     */
+    bool applyAffinity(size_t i) {
+        vector<unsigned> cpus = affinityCpus(affinity, i, t.size());
+        bool pinned = pinThread(t[i], cpus);
+        unsigned n = 0;
+        if (pinned && affinity.mode != AffinityMode::None)
+            n = cpuTopology().nodeOf(cpus.front());
+        node[i].store(n, memory_order_relaxed);
+        return pinned;
+    }
+
+    enum SlotState : unsigned char {
+        Empty,
+        Running,
+        Exited
+    };
+
+    // 只读（或很少写入）的状态：每次 start()/idleWait() 都会读取，放在一起且不与下面被频繁写入的状态共享缓存行
+    std::vector<std::thread> t;
+    std::atomic<bool> bStop;       // 线程是否停止（false 表示应退出线程）
+    std::atomic<unsigned> spinCount;
+    std::atomic<unsigned> yieldCount;
+    std::atomic<bool> adaptive;
+    std::unique_ptr<std::atomic<unsigned>[]> node;
+    size_t minWorkers;
+    size_t backlogThreshold;
+    chrono::steady_clock::duration keepAlive;
+    chrono::steady_clock::duration growAfter;
+
+    // 提交者（start）与后台线程（tryConsume）都会写入
+    alignas(CacheLineSize) std::atomic<size_t> nNotify;   // 待处理的唤醒次数
+
+    // 后台线程进入/离开阻塞时写入，提交者只读
+    alignas(CacheLineSize) std::atomic<size_t> nParked;   // 阻塞在条件变量上的线程数
+    std::atomic<int64_t> timedDeadline; // 限时阻塞线程等待的时刻
+
+    // 只在有线程阻塞时使用
+    alignas(CacheLineSize) std::mutex m;
     std::condition_variable c;
-    std::atomic<bool> bNotify; // 防止虚假唤醒
-    std::atomic<bool> bStop;   // 线程是否停止（false 表示应退出线程）
-    std::thread t;
+
+#ifdef LMC_ENABLE_STATS
+    /**
+     * 每个后台线程的空闲等待计数，只由该线程写入（relaxed 读-加-写），各自独占缓存行
+     */
+    struct alignas(CacheLineSize) IdleCounters {
+        std::atomic<uint64_t> spinWakeups{0};
+        std::atomic<uint64_t> yieldWakeups{0};
+        std::atomic<uint64_t> parks{0};
+    };
+
+    static void bump(std::atomic<uint64_t> &c) {
+        c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    std::unique_ptr<IdleCounters[]> idle;
+#endif
+
+    // 弹性线程数：只在创建/回收线程与修改绑定时使用
+    alignas(CacheLineSize) std::atomic<size_t> live;
+    std::unique_ptr<std::atomic<unsigned char>[]> slot;
+    std::mutex slotMutex;
+    AffinityPolicy affinity;
+    std::thread supervisor;
+    std::mutex supervisorMutex;
+    std::condition_variable supervisorCv;
 };
 
 /**
- * 构造函数：初始化控制标志，并启动后台线程。
+ * 构造函数：初始化控制标志，并启动 minWorkers 个后台线程（固定线程数时即 workers 个），
+ * 线程表按 maxWorkers 预先分配，之后增加的线程复用空闲的位置，编号始终小于 workerCount()。
+ *
+ * 每个后台线程循环逻辑（见 launch()）：
+ *  - 记录线程所属对象及编号，供 workerIndex() 查询
+ *  - 按 IdlePolicy 空闲等待，直到消耗到一次唤醒或 bStop 为 false
+ *  - 如果 bStop 为 false（或弹性线程空闲超时），则退出线程（return）
+ *  - 否则调用派生类的 run() 处理完当前所有可执行的工作，再回到空闲等待
  *
- * 后台线程循环逻辑：
- *  - 创建一个局部 mutex 并通过 unique_lock 上锁，以便与 condition_variable 协作
- *  - 使用 wait(predicate) 等待 bNotify 变为 true（避免虚假唤醒）
- *  - 如果 bStop 为 false，则退出线程（return）
- *  - 否则调用派生类的 run() 执行一次任务逻辑
+ * 阻塞前线程在 mutex 下先登记 nParked 再检查 nNotify，而 start() 先增加 nNotify 再检查 nParked，
+ * 两者均为顺序一致的原子操作，因此至少一方能看到另一方：要么线程看到唤醒不再阻塞，
+ * 要么 start() 看到有线程阻塞并在同一个 mutex 下通知——不会丢失唤醒。
  */
-Thread::Thread() : pImpl(std::make_unique<Impl>()) {
+Thread::Thread(size_t workers) : Thread(ElasticPolicy{workers, workers}) {}
+
+Thread::Thread(const ElasticPolicy &policy) : pImpl(std::make_unique<Impl>()) {
     pImpl->bStop = true;
-    pImpl->bNotify = false;
-
-    pImpl->t = thread([this] {
-        mutex localMutex;
-        unique_lock<mutex> localLock(localMutex);
-        while (1){
-            // 等待通知（bNotify 为 true 时继续）
-            pImpl->c.wait(localLock, [this] {
-                return pImpl->bNotify.load();
-            });
-
-            // 当 bStop 被置为 false（说明需要退出），线程返回并结束
-            if (!pImpl->bStop)
-                return;
-
-            // 被唤醒后执行派生类的 run() 一次工作逻辑
+    pImpl->nNotify = 0;
+    pImpl->nParked = 0;
+    pImpl->timedDeadline = INT64_MAX;
+    pImpl->spinCount = 0;
+    pImpl->yieldCount = 0;
+    pImpl->adaptive = false;
+    pImpl->live = 0;
+
+    size_t minWorkers = policy.minWorkers == 0 ? 1 : policy.minWorkers;
+    size_t workers = policy.maxWorkers < minWorkers ? minWorkers : policy.maxWorkers;
+    pImpl->minWorkers = minWorkers;
+    pImpl->backlogThreshold = policy.backlogThreshold;
+    pImpl->keepAlive = policy.keepAlive;
+    pImpl->growAfter = policy.growAfter < chrono::milliseconds(1) ? chrono::milliseconds(1) : policy.growAfter;
+
+#ifdef LMC_ENABLE_STATS
+    pImpl->idle.reset(new Impl::IdleCounters[workers]);
+#endif
+
+    pImpl->node.reset(new atomic<unsigned>[workers]);
+    pImpl->slot.reset(new atomic<unsigned char>[workers]);
+    for (size_t i = 0; i < workers; ++i) {
+        pImpl->node[i].store(0);
+        pImpl->slot[i].store(Impl::Empty);
+    }
+
+    pImpl->t.resize(workers);
+    lock_guard<mutex> lock(pImpl->slotMutex);
+    for (size_t i = 0; i < minWorkers; ++i)
+        launch(i, false);
+}
+
+/**
+ * runFirst 为 true 时（因积压而增加的线程）先调用一次 run() 再进入空闲等待：
+ * 积压的任务可能早已消耗完所有唤醒，新线程不能等待唤醒才开始工作
+ */
+void Thread::launch(size_t i, bool runFirst) {
+    pImpl->slot[i].store(Impl::Running);
+    pImpl->live.fetch_add(1);
+    pImpl->t[i] = std::thread([this, i, runFirst] {
+        tlsOwner = this;
+        tlsIndex = i;
+#ifdef LMC_ENABLE_TRACE
+        trace::setThreadName("lmc worker " + to_string(i));
+#endif
+
+        bool retireable = i >= pImpl->minWorkers;
+        unsigned spinLimit = 0;
+        Thread *owner = nullptr;
+        if (runFirst) {
+            owner = this;
+            pool::threadNode = pImpl->node[i].load(memory_order_relaxed);
             run();
         }
+        while (pImpl->idleWait(owner, spinLimit, retireable)) {
+            owner = this;
+            pool::threadNode = pImpl->node[i].load(memory_order_relaxed);
+            run();
+        }
+
+        pImpl->live.fetch_sub(1);
+        pImpl->slot[i].store(Impl::Exited);
     });
+    if (pImpl->affinity.mode != AffinityMode::None)
+        pImpl->applyAffinity(i);
+}
+
+void Thread::startElastic() {
+    if (pImpl->t.size() <= pImpl->minWorkers || pImpl->supervisor.joinable())
+        return;
+    pImpl->supervisor = std::thread([this] { supervise(); });
+}
+
+size_t Thread::backlog() {
+    return 0;
+}
+
+/**
+ * 每隔 growAfter 采样一次；连续两次采样都处于积压状态（没有阻塞等待的线程，且 backlog() 超过阈值）
+ * 才增加一个线程，单次的突发不会触发创建。同时 join 已因空闲超时退出的线程，使其位置可以复用。
+ */
+void Thread::supervise() {
+    unique_lock<mutex> lock(pImpl->supervisorMutex);
+    bool pressured = false;
+    while (pImpl->bStop.load()) {
+        pImpl->supervisorCv.wait_for(lock, pImpl->growAfter);
+        if (!pImpl->bStop.load())
+            break;
+
+        bool overloaded = pImpl->live.load() < pImpl->t.size() && pImpl->nParked.load() == 0 &&
+                          backlog() > pImpl->backlogThreshold;
+
+        lock_guard<mutex> slots(pImpl->slotMutex);
+        for (size_t i = pImpl->minWorkers; i < pImpl->t.size(); ++i) {
+            if (pImpl->slot[i].load() == Impl::Exited) {
+                pImpl->t[i].join();
+                pImpl->slot[i].store(Impl::Empty);
+            }
+        }
+
+        if (overloaded && pressured) {
+            for (size_t i = pImpl->minWorkers; i < pImpl->t.size(); ++i) {
+                if (pImpl->slot[i].load() == Impl::Empty) {
+                    launch(i, true);
+                    break;
+                }
+            }
+            overloaded = false;
+        }
+        pressured = overloaded;
+    }
 }
 
 Thread::~Thread() {}
 
+size_t Thread::workerCount() const {
+    return pImpl->t.size();
+}
+
+size_t Thread::liveWorkers() const {
+    return pImpl->live.load(memory_order_relaxed);
+}
+
+size_t Thread::workerIndex() const {
+    return tlsOwner == this ? tlsIndex : npos;
+}
+
+chrono::steady_clock::time_point Thread::nextWakeup() {
+    return chrono::steady_clock::time_point::max();
+}
+
+void Thread::setIdlePolicy(const IdlePolicy &policy) {
+    pImpl->spinCount.store(policy.spinCount);
+    pImpl->yieldCount.store(policy.yieldCount);
+    pImpl->adaptive.store(policy.adaptive);
+}
+
+IdleStats Thread::idleStats(size_t worker) const {
+    IdleStats stats;
+#ifdef LMC_ENABLE_STATS
+    if (worker < pImpl->t.size()) {
+        stats.spinWakeups = pImpl->idle[worker].spinWakeups.load(memory_order_relaxed);
+        stats.yieldWakeups = pImpl->idle[worker].yieldWakeups.load(memory_order_relaxed);
+        stats.parks = pImpl->idle[worker].parks.load(memory_order_relaxed);
+    }
+#else
+    (void)worker;
+#endif
+    return stats;
+}
+
+/**
+ * 新线程（弹性线程数增加的线程）创建时按最近一次设置的策略绑定
+ */
+bool Thread::setAffinity(const AffinityPolicy &policy) {
+    lock_guard<mutex> lock(pImpl->slotMutex);
+    pImpl->affinity = policy;
+    bool ok = true;
+    for (size_t i = 0; i < pImpl->t.size(); ++i)
+        if (pImpl->slot[i].load() == Impl::Running)
+            ok = pImpl->applyAffinity(i) && ok;
+    return ok;
+}
+
+unsigned Thread::workerNode(size_t worker) const {
+    return worker < pImpl->t.size() ? pImpl->node[worker].load(memory_order_relaxed) : 0;
+}
+
+IdlePolicy Thread::idlePolicy() const {
+    IdlePolicy policy;
+    policy.spinCount = pImpl->spinCount.load();
+    policy.yieldCount = pImpl->yieldCount.load();
+    policy.adaptive = pImpl->adaptive.load();
+    return policy;
+}
+
 /**
- * 停止通知：将 bNotify 置为 false，使条件变量等待在下一轮阻塞。
+ * 停止通知：清空待处理的唤醒次数，使后台线程在处理完当前工作后进入空闲等待。
  * 注意：这并不会直接退出线程，线程仍然存在；若需要销毁线程请调用 destory()。
  */
 void Thread::stop() {
-    // 必须由用户控制虚假唤醒与通知逻辑，这里仅更新通知标志
-    pImpl->bNotify.store(false);
+    pImpl->nNotify.store(0);
 }
 
 /**
- * 唤醒线程：设置通知标志并通知条件变量，后台线程会在条件满足时被唤醒并执行 run()
+ * 唤醒线程：增加唤醒次数，若有线程阻塞在条件变量上，则在共享 mutex 下通知其中一个。
+ * 唤醒次数最多累积到后台线程数，多余的唤醒没有意义（每个被唤醒的线程都会处理完所有工作）。
+ * 没有线程阻塞时（全部忙碌或处于自旋阶段）无需加锁，也不调用 notify。
  */
 void Thread::start() {
-    pImpl->bNotify.store(true);
+    size_t n = pImpl->nNotify.load();
+    do {
+        if (n >= pImpl->t.size())
+            return;
+    } while (!pImpl->nNotify.compare_exchange_weak(n, n + 1));
+
+    if (pImpl->nParked.load() == 0)
+        return;
+
+    // 加锁保证阻塞线程要么尚未检查 nNotify，要么已进入 wait，notify 不会落空
+    { lock_guard<mutex> lock(pImpl->m); }
     pImpl->c.notify_one();
 }
 
 /**
- * 销毁线程：将 bStop 设置为 false，表示线程应退出；随后调用 start() 唤醒线程以便其能检测到 bStop，
- * 最后 join 后台线程以回收资源。
+ * 批量唤醒：增加至多 n 次唤醒（总数不超过后台线程数），然后通知与新增唤醒数相同数量的阻塞线程
+ */
+void Thread::start(size_t n) {
+    size_t cur = pImpl->nNotify.load();
+    size_t added = 0;
+    do {
+        size_t room = pImpl->t.size() > cur ? pImpl->t.size() - cur : 0;
+        added = n < room ? n : room;
+        if (added == 0)
+            return;
+    } while (!pImpl->nNotify.compare_exchange_weak(cur, cur + added));
+
+    size_t parked = pImpl->nParked.load();
+    if (parked == 0)
+        return;
+
+    { lock_guard<mutex> lock(pImpl->m); }
+    if (added >= parked) {
+        pImpl->c.notify_all();
+    } else {
+        for (size_t i = 0; i < added; ++i)
+            pImpl->c.notify_one();
+    }
+}
+
+/**
+ * 销毁线程：将 bStop 设置为 false，表示线程应退出；随后唤醒所有线程以便其能检测到 bStop，
+ * 先 join 监控线程（之后不再创建新线程），最后 join 全部后台线程以回收资源。
  *
- * 这是一个阻塞调用（直到线程退出并 join）。
+ * 这是一个阻塞调用（直到线程退出并 join）；重复调用时已 join 的线程会被跳过。
  */
 void Thread::destory() {
-    pImpl->bStop = false;
-    start();
-    pImpl->t.join();
-}
\ No newline at end of file
+    {
+        lock_guard<mutex> lock(pImpl->m);
+        pImpl->bStop = false;
+    }
+    pImpl->c.notify_all();
+
+    { lock_guard<mutex> lock(pImpl->supervisorMutex); }
+    pImpl->supervisorCv.notify_all();
+    if (pImpl->supervisor.joinable())
+        pImpl->supervisor.join();
+
+    lock_guard<mutex> lock(pImpl->slotMutex);
+    for (auto &t : pImpl->t)
+        if (t.joinable())
+            t.join();
+}
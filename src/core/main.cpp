@@ -131,9 +131,12 @@ int main() {
                 demo_batch_tasks();
                 break;
             case 4:
-                // 运行测试套件
+                // 依次运行所有演示；性能数据请使用 bench_workqueue
                 cout << "\n运行完整测试套件..." << endl;
-                // 这里可以调用测试函数
+                demo_fibonacci();
+                demo_file_processing();
+                demo_batch_tasks();
+                cout << "\n全部演示完成（吞吐与延迟基准见 bench_workqueue）" << endl;
                 break;
             case 0:
                 cout << "程序退出" << endl;
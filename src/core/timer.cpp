@@ -0,0 +1,163 @@
+#include "timer.h"
+
+using namespace lmc;
+using namespace std;
+
+/**
+ * tick 精度：1ms
+ */
+static const auto TICK = chrono::milliseconds(1);
+
+TimerService::TimerService() : wheel(0), epoch(Clock::now()), nextDueTick(INT64_MAX), count(0) {}
+
+TimerService::~TimerService() {
+    clear();
+}
+
+/**
+ * 时刻转换为 tick：向上取整，保证定时器不会早于 deadline 到期
+ */
+uint64_t TimerService::toTick(Clock::time_point t) const {
+    if (t <= epoch)
+        return 0;
+    auto d = t - epoch;
+    auto ticks = chrono::duration_cast<chrono::milliseconds>(d).count();
+    if (chrono::milliseconds(ticks) < d)
+        ++ticks;
+    return static_cast<uint64_t>(ticks);
+}
+
+/**
+ * 在持锁状态下刷新无锁查询用的状态
+ */
+void TimerService::updateNextDeadline() {
+    uint64_t next = wheel.nextEvent();
+    nextDueTick.store(next >= static_cast<uint64_t>(INT64_MAX) ? INT64_MAX : static_cast<int64_t>(next),
+                      memory_order_release);
+    count.store(wheel.size(), memory_order_release);
+}
+
+shared_ptr<TimerNode> TimerService::arm(Clock::time_point when, Task &&task, Clock::duration period,
+                                        bool &dueNow) {
+    auto node = make_shared<TimerNode>();
+    node->task = move(task);
+    node->deadline = when;
+    node->period = period;
+    node->expiry = toTick(when);
+
+    dueNow = when <= Clock::now();
+    if (dueNow)
+        return node;
+
+    lock_guard<mutex> lock(m);
+    if (closed) {
+        // 不进入定时轮，节点连同任务由调用者在锁外释放
+        node->cancelled = true;
+        return node;
+    }
+    if (!wheel.insert(node.get())) {
+        dueNow = true;
+        return node;
+    }
+    node->self = node;
+    updateNextDeadline();
+    return node;
+}
+
+bool TimerService::beginRun(const shared_ptr<TimerNode> &node) {
+    lock_guard<mutex> lock(m);
+    return !node->cancelled;
+}
+
+bool TimerService::rearm(const shared_ptr<TimerNode> &node, Clock::time_point when, bool &dueNow) {
+    dueNow = false;
+    lock_guard<mutex> lock(m);
+    if (node->cancelled || closed)
+        return false;
+
+    node->deadline = when;
+    node->expiry = toTick(when);
+    if (when <= Clock::now() || !wheel.insert(node.get())) {
+        dueNow = true;
+        return false;
+    }
+    node->self = node;
+    updateNextDeadline();
+    return true;
+}
+
+bool TimerService::cancel(const shared_ptr<TimerNode> &node) {
+    // 任务与自引用在解锁后再析构：任务的析构可能执行用户代码（例如 promise 报告 broken_promise）
+    Task dropped;
+    shared_ptr<TimerNode> self;
+    {
+        lock_guard<mutex> lock(m);
+        if (node->cancelled)
+            return false;
+
+        if (node->linked()) {
+            wheel.remove(node.get());
+            updateNextDeadline();
+            dropped = move(node->task);
+            self = move(node->self);
+        } else if (node->period == Clock::duration::zero()) {
+            // 一次性定时器已经到期（正在或已经执行），无法取消
+            return false;
+        }
+        // 周期定时器已到期（排队等待或正在执行）：标记后不再开始执行（见 beginRun），也不再重新登记
+        node->cancelled = true;
+    }
+    return true;
+}
+
+void TimerService::collect(Clock::time_point now, vector<shared_ptr<TimerNode>> &due) {
+    unique_lock<mutex> lock(m, try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
+    uint64_t nowTick = now <= epoch ? 0 : static_cast<uint64_t>(
+                           chrono::duration_cast<chrono::milliseconds>(now - epoch).count());
+    wheel.advance(nowTick, [&due](TimerWheelNode *n) {
+        due.push_back(move(static_cast<TimerNode *>(n)->self));
+    });
+    updateNextDeadline();
+}
+
+TimerService::Clock::time_point TimerService::nextDeadline() const {
+    int64_t tick = nextDueTick.load(memory_order_acquire);
+    if (tick == INT64_MAX)
+        return Clock::time_point::max();
+    return epoch + tick * TICK;
+}
+
+void TimerService::clear() {
+    vector<shared_ptr<TimerNode>> removed;
+    {
+        lock_guard<mutex> lock(m);
+        wheel.drain([&removed](TimerWheelNode *n) {
+            auto *node = static_cast<TimerNode *>(n);
+            node->cancelled = true;
+            removed.push_back(move(node->self));
+        });
+        updateNextDeadline();
+    }
+    // 在锁外释放节点及其任务
+    for (auto &n : removed)
+        n->task = nullptr;
+}
+
+void TimerService::close() {
+    {
+        lock_guard<mutex> lock(m);
+        closed = true;
+    }
+    clear();
+}
+
+bool TimerHandle::cancel() {
+    auto s = service.lock();
+    auto n = node.lock();
+    if (!s || !n)
+        return false;
+    return s->cancel(n);
+}
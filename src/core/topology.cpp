@@ -0,0 +1,132 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace lmc;
+using namespace std;
+
+#if defined(__linux__)
+
+/**
+ * 解析内核的 CPU 列表格式，例如 "0-3,8,10-11"
+ */
+static vector<unsigned> parseCpuList(const string &text) {
+    vector<unsigned> out;
+    stringstream ss(text);
+    string part;
+    while (getline(ss, part, ',')) {
+        if (part.empty() || part[0] < '0' || part[0] > '9')
+            continue;
+        size_t dash = part.find('-');
+        unsigned lo = static_cast<unsigned>(stoul(part.substr(0, dash)));
+        unsigned hi = dash == string::npos ? lo : static_cast<unsigned>(stoul(part.substr(dash + 1)));
+        for (unsigned i = lo; i <= hi; ++i)
+            out.push_back(i);
+    }
+    return out;
+}
+
+static bool readLine(const string &path, string &line) {
+    ifstream in(path);
+    return static_cast<bool>(getline(in, line));
+}
+
+static unsigned readNumber(const string &path, unsigned fallback) {
+    string line;
+    if (!readLine(path, line) || line.empty() || line[0] < '0' || line[0] > '9')
+        return fallback;
+    return static_cast<unsigned>(stoul(line));
+}
+
+static void detect(CpuTopology &topo) {
+    const string base = "/sys/devices/system/";
+    string line;
+    if (!readLine(base + "cpu/online", line))
+        return;
+
+    for (unsigned id : parseCpuList(line)) {
+        string dir = base + "cpu/cpu" + to_string(id) + "/topology/";
+        CpuTopology::Cpu cpu;
+        cpu.id = id;
+        cpu.core = readNumber(dir + "core_id", id);
+        cpu.package = readNumber(dir + "physical_package_id", 0);
+        cpu.node = 0;
+        topo.cpus.push_back(cpu);
+    }
+
+    // 没有 NUMA 信息（未启用 NUMA 的内核）时所有 CPU 属于节点 0
+    if (!readLine(base + "node/online", line))
+        return;
+    vector<unsigned> nodes = parseCpuList(line);
+    for (unsigned node : nodes) {
+        string cpus;
+        if (!readLine(base + "node/node" + to_string(node) + "/cpulist", cpus))
+            continue;
+        for (unsigned id : parseCpuList(cpus))
+            for (auto &cpu : topo.cpus)
+                if (cpu.id == id)
+                    cpu.node = node;
+    }
+    if (!nodes.empty())
+        topo.nodeCount = *max_element(nodes.begin(), nodes.end()) + 1;
+}
+
+#else
+
+static void detect(CpuTopology &) {}
+
+#endif
+
+vector<unsigned> CpuTopology::physicalCores() const {
+    vector<Cpu> sorted = cpus;
+    sort(sorted.begin(), sorted.end(), [](const Cpu &a, const Cpu &b) {
+        if (a.node != b.node)
+            return a.node < b.node;
+        return a.id < b.id;
+    });
+
+    vector<unsigned> out;
+    vector<pair<unsigned, unsigned>> seen; // (package, core)
+    for (const Cpu &c : sorted) {
+        auto key = make_pair(c.package, c.core);
+        if (find(seen.begin(), seen.end(), key) != seen.end())
+            continue;
+        seen.push_back(key);
+        out.push_back(c.id);
+    }
+    return out;
+}
+
+vector<unsigned> CpuTopology::nodeCpus(unsigned node) const {
+    vector<unsigned> out;
+    for (const Cpu &c : cpus)
+        if (c.node == node)
+            out.push_back(c.id);
+    return out;
+}
+
+unsigned CpuTopology::nodeOf(unsigned id) const {
+    for (const Cpu &c : cpus)
+        if (c.id == id)
+            return c.node;
+    return 0;
+}
+
+const CpuTopology &lmc::cpuTopology() {
+    static const CpuTopology topo = [] {
+        CpuTopology t;
+        detect(t);
+        if (t.cpus.empty()) {
+            unsigned n = thread::hardware_concurrency();
+            for (unsigned i = 0; i < (n == 0 ? 1 : n); ++i)
+                t.cpus.push_back(CpuTopology::Cpu{i, i, 0, 0});
+            t.nodeCount = 1;
+        }
+        return t;
+    }();
+    return topo;
+}
@@ -0,0 +1,319 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace lmc;
+using namespace std;
+
+atomic<bool> trace::detail::on{false};
+
+namespace {
+
+/**
+ * Slot - 环形缓冲区中的一个事件；字段为原子变量，导出线程与写入线程并发访问时没有数据竞争
+ */
+struct Slot {
+    atomic<int64_t> start;
+    atomic<int64_t> duration;
+    atomic<uint64_t> meta;   // 高 8 位为事件类型，其余为参数
+};
+
+static constexpr size_t Mask = trace::BufferEvents - 1;
+static_assert((trace::BufferEvents & Mask) == 0, "BufferEvents must be a power of two");
+
+/**
+ * Buffer - 一个线程的单写者环形缓冲区
+ *
+ * 写入第 i 个事件前先把 writing 置为 i + 1，写完再把 head 置为 i + 1：
+ * 导出线程先读 head，复制事件，再读 writing，序号小于 writing - BufferEvents 的事件可能已被覆盖，丢弃
+ * （与顺序锁相同的思路，以字段的 release / acquire 代替栅栏，ThreadSanitizer 也能理解）
+ */
+struct Buffer {
+    Buffer() : slots(new Slot[trace::BufferEvents]) {}
+
+    unique_ptr<Slot[]> slots;
+    atomic<uint64_t> head{0};      // 已写完的事件数
+    atomic<uint64_t> writing{0};   // 已开始写入的事件数
+    unsigned tid = 0;              // 以下字段受 Registry::m 保护
+    string name;
+    uint64_t clearedAt = 0;        // clear() 时的 head，之前的事件不再导出
+    bool inUse = false;
+};
+
+/**
+ * Registry - 所有线程的缓冲区；线程退出后缓冲区留给之后的线程复用，
+ * 不会因为弹性线程反复创建而无限增长
+ */
+struct Registry {
+    mutex m;
+    vector<unique_ptr<Buffer>> buffers;
+    unsigned nextTid = 1;
+};
+
+/**
+ * 不析构：进程退出阶段仍可能有线程在记录
+ */
+Registry &registry() {
+    static Registry *r = new Registry;
+    return *r;
+}
+
+struct Holder {
+    ~Holder();
+    Buffer *buffer = nullptr;
+};
+
+thread_local Holder holder;
+thread_local Buffer *tlsBuffer = nullptr;   // 平凡析构，访问时没有线程局部变量的初始化检查
+thread_local bool holderDestroyed = false;
+thread_local string threadName;   // 第一次记录前设置的名称，登记缓冲区时使用
+
+Holder::~Holder() {
+    holderDestroyed = true;
+    tlsBuffer = nullptr;
+    if (buffer) {
+        lock_guard<mutex> lock(registry().m);
+        buffer->inUse = false;
+    }
+}
+
+Buffer *localBuffer() {
+    if (tlsBuffer)
+        return tlsBuffer;
+    if (holderDestroyed)
+        return nullptr;
+
+    Registry &r = registry();
+    lock_guard<mutex> lock(r.m);
+    Buffer *b = nullptr;
+    for (auto &candidate : r.buffers) {
+        if (!candidate->inUse) {
+            b = candidate.get();
+            break;
+        }
+    }
+    if (!b) {
+        r.buffers.emplace_back(new Buffer);
+        b = r.buffers.back().get();
+    }
+    b->head.store(0, memory_order_relaxed);
+    b->writing.store(0, memory_order_relaxed);
+    b->tid = r.nextTid++;
+    b->name = threadName;
+    b->clearedAt = 0;
+    b->inUse = true;
+    holder.buffer = b;
+    tlsBuffer = b;
+    return b;
+}
+
+struct Record {
+    int64_t start;
+    int64_t duration;
+    uint64_t meta;
+    unsigned tid;
+};
+
+/**
+ * 复制一个缓冲区中仍然有效的事件（调用方持有 Registry::m，缓冲区不会被复用或重置）
+ */
+void collect(const Buffer &b, vector<Record> &out) {
+    uint64_t head = b.head.load(memory_order_acquire);
+    uint64_t first = head > trace::BufferEvents ? head - trace::BufferEvents : 0;
+    first = max(first, b.clearedAt);
+
+    size_t base = out.size();
+    for (uint64_t i = first; i < head; ++i) {
+        const Slot &s = b.slots[i & Mask];
+        out.push_back(Record{s.start.load(memory_order_acquire), s.duration.load(memory_order_acquire),
+                             s.meta.load(memory_order_acquire), b.tid});
+    }
+
+    uint64_t writing = b.writing.load(memory_order_relaxed);
+    uint64_t valid = writing > trace::BufferEvents ? writing - trace::BufferEvents : 0;
+    if (valid > first) {
+        size_t stale = static_cast<size_t>(min(valid, head) - first);
+        out.erase(out.begin() + static_cast<ptrdiff_t>(base),
+                  out.begin() + static_cast<ptrdiff_t>(base + stale));
+    }
+}
+
+void writeEscaped(ostream &out, const string &s) {
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\')
+            out << '\\' << ch;
+        else if (static_cast<unsigned char>(ch) < 0x20)
+            out << ' ';
+        else
+            out << ch;
+    }
+}
+
+/**
+ * 时钟校准的起点：进程启动时同时读取跟踪时钟与 steady_clock
+ */
+struct ClockPoint {
+    int64_t ticks;
+    chrono::steady_clock::time_point steady;
+};
+
+const ClockPoint calibrationBase{trace::now(), chrono::steady_clock::now()};
+
+/**
+ * 跟踪时钟每个计数对应的纳秒数；TSC 与 steady_clock 的对应关系至少在 10ms 的区间上测量
+ */
+double nanosPerTick() {
+#ifdef LMC_TRACE_TSC
+    auto minSpan = chrono::milliseconds(10);
+    while (chrono::steady_clock::now() - calibrationBase.steady < minSpan)
+        this_thread::yield();
+    ClockPoint cur{trace::now(), chrono::steady_clock::now()};
+    double ns = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(cur.steady - calibrationBase.steady).count());
+    return cur.ticks > calibrationBase.ticks ? ns / static_cast<double>(cur.ticks - calibrationBase.ticks) : 1.0;
+#else
+    return 1e9 * chrono::steady_clock::period::num / chrono::steady_clock::period::den;
+#endif
+}
+
+/**
+ * 跟踪时钟计数 -> 微秒（trace-event 的时间单位），保留纳秒精度
+ */
+void writeMicros(ostream &out, int64_t ticks, double nsPerTick) {
+    auto ns = static_cast<long long>(static_cast<double>(ticks) * nsPerTick);
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld.%03lld", ns / 1000, ns < 0 ? -(ns % 1000) : ns % 1000);
+    out << buf;
+}
+}
+
+void trace::detail::record(Event e, int64_t start, int64_t duration, uint64_t arg) noexcept {
+    Buffer *b = localBuffer();
+    if (!b)
+        return;
+
+    uint64_t i = b->head.load(memory_order_relaxed);
+    b->writing.store(i + 1, memory_order_relaxed);
+
+    // release 存储（x86 上即普通存储）：导出线程读到本次写入的任一字段时，也能看到上面的 writing
+    Slot &s = b->slots[i & Mask];
+    s.start.store(start, memory_order_release);
+    s.duration.store(duration, memory_order_release);
+    s.meta.store(static_cast<uint64_t>(e) << 56 | (arg & ((uint64_t(1) << 56) - 1)), memory_order_release);
+    b->head.store(i + 1, memory_order_release);
+}
+
+void trace::enable(bool enabled) noexcept {
+    detail::on.store(enabled, memory_order_relaxed);
+}
+
+/**
+ * 尚未记录过事件的线程只保存名称，不为其分配缓冲区
+ */
+void trace::setThreadName(const string &name) {
+    if (holderDestroyed)
+        return;
+    threadName = name;
+    if (holder.buffer) {
+        lock_guard<mutex> lock(registry().m);
+        holder.buffer->name = name;
+    }
+}
+
+/**
+ * 不修改写入线程的位置，只记录每个缓冲区当前的 head，导出时跳过其之前的事件
+ */
+void trace::clear() {
+    Registry &r = registry();
+    lock_guard<mutex> lock(r.m);
+    for (auto &b : r.buffers)
+        b->clearedAt = b->head.load(memory_order_acquire);
+}
+
+void trace::dump(ostream &out) {
+    vector<Record> records;
+    vector<pair<unsigned, string>> names;
+    {
+        Registry &r = registry();
+        lock_guard<mutex> lock(r.m);
+        for (auto &b : r.buffers) {
+            if (b->head.load(memory_order_acquire) == b->clearedAt)
+                continue;
+            collect(*b, records);
+            names.emplace_back(b->tid, b->name.empty() ? "thread " + to_string(b->tid) : b->name);
+        }
+    }
+
+    int64_t origin = INT64_MAX;
+    for (const Record &rec : records)
+        origin = min(origin, rec.start);
+    double scale = nanosPerTick();
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    auto begin = [&] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    for (const auto &n : names) {
+        begin();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << n.first << ",\"args\":{\"name\":\"";
+        writeEscaped(out, n.second);
+        out << "\"}}";
+    }
+
+    for (const Record &rec : records) {
+        Event e = static_cast<Event>(rec.meta >> 56);
+        uint64_t arg = rec.meta & ((uint64_t(1) << 56) - 1);
+        begin();
+        switch (e) {
+        case Event::Task:
+            out << "{\"name\":\"task\",\"cat\":\"task\",\"ph\":\"X\"";
+            break;
+        case Event::Steal:
+            out << "{\"name\":\"steal\",\"cat\":\"sched\",\"ph\":\"i\",\"s\":\"t\"";
+            break;
+        case Event::Park:
+            out << "{\"name\":\"park\",\"cat\":\"idle\",\"ph\":\"X\"";
+            break;
+        case Event::LockWait:
+            out << "{\"name\":\"lock wait\",\"cat\":\"lock\",\"ph\":\"X\"";
+            break;
+        }
+        out << ",\"pid\":1,\"tid\":" << rec.tid << ",\"ts\":";
+        writeMicros(out, rec.start - origin, scale);
+        if (e != Event::Steal) {
+            out << ",\"dur\":";
+            writeMicros(out, rec.duration, scale);
+        }
+        switch (e) {
+        case Event::Task:
+            out << ",\"args\":{\"wait_us\":";
+            writeMicros(out, static_cast<int64_t>(arg), scale);
+            out << "}";
+            break;
+        case Event::Steal:
+            out << ",\"args\":{\"victim\":" << arg << "}";
+            break;
+        default:
+            break;
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+}
+
+bool trace::dump(const string &path) {
+    ofstream out(path);
+    if (!out)
+        return false;
+    dump(out);
+    out.flush();
+    return static_cast<bool>(out);
+}
@@ -1,5 +1,7 @@
 #include "workqueue.h"
 
+#include <iostream>
+
 using namespace lmc;
 
 /**
@@ -13,7 +15,10 @@ void SMutex::setMutexType(MutexType m) {
  * lock()/unlock() 根据配置的互斥类型执行不同操作：
  * - MutexType::Mutex -> std::mutex
  * - MutexType::Spin  -> 自旋锁
+ * - MutexType::Ticket -> 排号自旋锁
+ * - MutexType::Mcs   -> MCS 队列锁
  * - MutexType::None  -> 不做任何操作（调用者需保证并发安全）
+ * - MutexType::LockFree -> 不做任何操作（全局队列为无锁环形队列，不经过 SMutex）
  */
 void SMutex::lock() {
     switch (mMutexType) {
@@ -23,7 +28,14 @@ void SMutex::lock() {
         case MutexType::Spin:
             mSpinMutex.lock();
         break;
+        case MutexType::Ticket:
+            mTicketMutex.lock();
+        break;
+        case MutexType::Mcs:
+            mMcsMutex.lock();
+        break;
         case MutexType::None:
+        case MutexType::LockFree:
         return;
         break;
     }
@@ -37,56 +49,391 @@ void SMutex::unlock() {
         case MutexType::Spin:
             mSpinMutex.unlock();
         break;
+        case MutexType::Ticket:
+            mTicketMutex.unlock();
+        break;
+        case MutexType::Mcs:
+            mMcsMutex.unlock();
+        break;
         case MutexType::None:
+        case MutexType::LockFree:
         return;
         break;
     }
 }
 
+WorkQueueBase::WorkQueueBase(const ElasticPolicy &policy)
+    : Thread(policy), maxQueued(0), overflow(OverflowPolicy::Block), nBlocked(0), closed(false),
+      cancelling(false), timers(make_shared<TimerService>()), queued(0), dropped(0), busy(0),
+      finished(false) {
+    // 后台线程在首次 start() 之前不会调用 run()，此时创建本地队列是安全的；
+    // 弹性线程数时按上限为每个可能的后台线程预先创建，之后增加线程无需修改该表
+    deques.reserve(workerCount());
+    for (size_t i = 0; i < workerCount(); ++i)
+        deques.emplace_back(new LocalDeque());
+
+#ifdef LMC_ENABLE_STATS
+    externalExecuted = 0;
+    counters.reserve(workerCount());
+    for (size_t i = 0; i < workerCount(); ++i)
+        counters.emplace_back(new WorkerCounters());
+#endif
+}
+
 /**
- * 构造函数：设置互斥类型
+ * 派生类析构时已调用 destory()，后台线程已全部退出，释放本地队列中尚未执行的任务
  */
-WorkQueue::WorkQueue(MutexType m) {
-    mutex.setMutexType(m);
+WorkQueueBase::~WorkQueueBase() {
+    discardLocal();
+}
+
+void WorkQueueBase::setCapacity(size_t capacity, OverflowPolicy policy) {
+    maxQueued = capacity;
+    overflow = policy;
+}
+
+size_t WorkQueueBase::droppedTasks() const {
+    return dropped.load(memory_order_relaxed);
+}
+
+void WorkQueueBase::waitForSpace() {
+    // 先唤醒后台线程：调用者可能还没有为已入队的任务调用 start()（例如批量提交）
+    start(workerCount());
+    unique_lock<std::mutex> lock(spaceMutex);
+    ++nBlocked;
+    while (queued.load() >= maxQueued && !closed.load())
+        spaceCv.wait(lock);
+    --nBlocked;
+}
+
+void WorkQueueBase::releaseSlot() {
+    queued.fetch_sub(1);
+    if (nBlocked.load() == 0)
+        return;
+
+    { lock_guard<std::mutex> lock(spaceMutex); }
+    spaceCv.notify_one();
+}
+
+void WorkQueueBase::wakeBlocked() {
+    { lock_guard<std::mutex> lock(spaceMutex); }
+    spaceCv.notify_all();
+}
+
+size_t WorkQueueBase::localCount() const {
+    size_t n = 0;
+    for (auto &d : deques)
+        n += d->size();
+    return n;
+}
+
+bool WorkQueueBase::localEmpty() const {
+    for (auto &d : deques)
+        if (!d->empty())
+            return false;
+    return true;
+}
+
+void WorkQueueBase::discardLocal() {
+    Task *task = nullptr;
+    for (auto &d : deques)
+        while (d->pop(task))
+            deleteNode(task);
+}
+
+bool WorkQueueBase::steal(size_t idx, Task &task) {
+    Task *local = nullptr;
+    size_t n = deques.size();
+    size_t first = idx == npos ? 0 : idx + 1;
+    unsigned node = idx == npos ? 0 : workerNode(idx);
+    for (size_t k = 0; k < 2 * n; ++k) {
+        size_t victim = (first + k) % n;
+        bool sameNode = idx == npos || workerNode(victim) == node;
+        if (sameNode != (k < n) || victim == idx)
+            continue;
+        if (deques[victim]->steal(local)) {
+            task = move(*local);
+            deleteNode(local);
+#ifdef LMC_ENABLE_STATS
+            if (idx != npos)
+                bump(counters[idx]->steals);
+#endif
+#ifdef LMC_ENABLE_TRACE
+            if (trace::active())
+                trace::record(trace::Event::Steal, trace::now(), 0, victim);
+#endif
+            return true;
+        }
+    }
+    return false;
+}
+
+chrono::steady_clock::time_point WorkQueueBase::nextWakeup() {
+    return timers->nextDeadline();
 }
 
 /**
- * 析构函数：
- * - 在析构时先对队列加锁并清空队列
- * - 然后调用基类的 destory() 停止并 join 后台线程，确保派生类析构时不会因为基类线程调用纯虚函数导致崩溃
- * - 最后释放互斥锁
+ * addTask 的任务会把异常写入 promise，只有 post() 的任务会让异常逃逸到这里
  */
-WorkQueue::~WorkQueue() {
-    mutex.lock();
-    while (!workqueue.empty()) 
-        workqueue.pop();
+void WorkQueueBase::execute(Task &task) {
+#ifdef LMC_ENABLE_STATS
+    size_t idx = workerIndex();
+    auto begin = chrono::steady_clock::now();
+    int64_t enqueued = task.enqueueTime();
+    if (idx != npos && enqueued != 0) {
+        int64_t waited = begin.time_since_epoch().count() - enqueued;
+        counters[idx]->waitTime.record(static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::duration(waited > 0 ? waited : 0)).count()));
+    }
+#endif
+
+#ifdef LMC_ENABLE_TRACE
+    int64_t traceBegin = trace::active() ? trace::now() : 0;
+    int64_t traceEnqueued = task.enqueueTime();
+#endif
+
+    // 在不持锁的情况下执行任务，避免长期占用互斥体
+    try {
+        task();
+    } catch (...) {
+        handleException(current_exception());
+    }
+    task = nullptr;
+
+#ifdef LMC_ENABLE_TRACE
+    if (traceBegin != 0) {
+        int64_t waited = traceEnqueued != 0 && traceBegin > traceEnqueued ? traceBegin - traceEnqueued : 0;
+        trace::record(trace::Event::Task, traceBegin, trace::now() - traceBegin, static_cast<uint64_t>(waited));
+    }
+#endif
 
-    // 将基类的线程销毁操作转交给派生类执行
-    destory();
-    mutex.unlock();
+#ifdef LMC_ENABLE_STATS
+    if (idx == npos) {
+        externalExecuted.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    auto ran = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin);
+    counters[idx]->runTime.record(static_cast<uint64_t>(ran.count()));
+    bump(counters[idx]->executed);
+#endif
+}
+
+void WorkQueueBase::collectStats(WorkQueueStats &out) const {
+    out.queuedLocal = localCount();
+    out.liveWorkers = liveWorkers();
+
+#ifdef LMC_ENABLE_STATS
+    out.enabled = true;
+    out.externalExecuted = externalExecuted.load(memory_order_relaxed);
+    out.workers.resize(workerCount());
+    HistogramSnapshot h;
+    for (size_t i = 0; i < workerCount(); ++i) {
+        const WorkerCounters &c = *counters[i];
+        WorkerStats &w = out.workers[i];
+        w.executed = c.executed.load(memory_order_relaxed);
+        w.steals = c.steals.load(memory_order_relaxed);
+
+        IdleStats idle = idleStats(i);
+        w.spinWakeups = idle.spinWakeups;
+        w.yieldWakeups = idle.yieldWakeups;
+        w.parks = idle.parks;
+
+        c.waitTime.snapshot(h);
+        out.waitTime += h;
+        c.runTime.snapshot(h);
+        out.runTime += h;
+    }
+#else
+    out.workers.resize(workerCount());
+#endif
+}
+
+void WorkQueueBase::setExceptionHandler(function<void(exception_ptr)> handler) {
+    lock_guard<std::mutex> lock(handlerMutex);
+    exceptionHandler = move(handler);
+}
+
+void WorkQueueBase::handleException(exception_ptr e) {
+    function<void(exception_ptr)> handler;
+    {
+        lock_guard<std::mutex> lock(handlerMutex);
+        handler = exceptionHandler;
+    }
+
+    if (handler) {
+        handler(e);
+        return;
+    }
+
+    try {
+        rethrow_exception(e);
+    } catch (const exception &ex) {
+        cerr << "WorkQueue: 任务抛出未处理的异常: " << ex.what() << endl;
+    } catch (...) {
+        cerr << "WorkQueue: 任务抛出未处理的未知异常" << endl;
+    }
 }
 
 /**
- * run() 实现：从队列中取出一个任务并执行
+ * WorkQueue::Impl - 与具体策略无关的队列接口，由 ImplFor 转发给对应的 BasicWorkQueue
  */
-void WorkQueue::run() {
-    mutex.lock();
-    if (workqueue.empty()) {
-        mutex.unlock();
-        return;
+class WorkQueue::Impl {
+public:
+    virtual ~Impl() = default;
+    virtual bool submit(Task &&task, Priority priority, bool tryOnly) = 0;
+    virtual void submitBatch(vector<Task> &&tasks) = 0;
+    virtual TimerHandle schedule(chrono::steady_clock::time_point when, Task &&task,
+                                 chrono::steady_clock::duration period) = 0;
+    virtual bool runPendingTask() = 0;
+    virtual WorkQueueBase &base() = 0;
+    virtual void stopWorkQueue() = 0;
+    virtual bool shutdown(ShutdownMode mode, chrono::steady_clock::duration timeout) = 0;
+    virtual WorkQueueStats stats() const = 0;
+};
+
+template <typename LockPolicy, typename QueuePolicy>
+class WorkQueue::ImplFor final : public WorkQueue::Impl {
+public:
+    explicit ImplFor(const ElasticPolicy &policy) : queue(policy) {}
+
+    bool submit(Task &&task, Priority priority, bool tryOnly) override {
+        return queue.submit(move(task), priority, tryOnly);
     }
 
-    auto f = move(workqueue.front());
-    workqueue.pop();
-    mutex.unlock();
+    void submitBatch(vector<Task> &&tasks) override {
+        queue.submitBatch(move(tasks));
+    }
 
-    // 在不持锁的情况下执行任务，避免长期占用互斥体
-    f();
+    TimerHandle schedule(chrono::steady_clock::time_point when, Task &&task,
+                         chrono::steady_clock::duration period) override {
+        return queue.schedule(when, move(task), period);
+    }
+
+    bool runPendingTask() override {
+        return queue.runPendingTask();
+    }
+
+    WorkQueueBase &base() override {
+        return queue;
+    }
+
+    void stopWorkQueue() override {
+        queue.stopWorkQueue();
+    }
+
+    bool shutdown(ShutdownMode mode, chrono::steady_clock::duration timeout) override {
+        return queue.shutdown(mode, timeout);
+    }
+
+    WorkQueueStats stats() const override {
+        return queue.stats();
+    }
+
+private:
+    BasicWorkQueue<LockPolicy, QueuePolicy> queue;
+};
+
+/**
+ * 按互斥类型选择编译期策略：
+ * - MutexType::None 使用无等待的 SPSC 环形队列：一个外部提交线程、一个后台线程
+ * - MutexType::LockFree 使用无锁环形队列，不需要锁
+ */
+unique_ptr<WorkQueue::Impl> WorkQueue::makeImpl(MutexType m, const ElasticPolicy &workers) {
+    switch (m) {
+        case MutexType::None:
+        return make_unique<ImplFor<NullMutex, SpscRing>>(workers);
+        case MutexType::Spin:
+        return make_unique<ImplFor<SpinMutex, LinkedQueue>>(workers);
+        case MutexType::Mutex:
+        return make_unique<ImplFor<std::mutex, LinkedQueue>>(workers);
+        case MutexType::LockFree:
+        return make_unique<ImplFor<NullMutex, RingQueue>>(workers);
+        case MutexType::Ticket:
+        return make_unique<ImplFor<TicketMutex, LinkedQueue>>(workers);
+        case MutexType::Mcs:
+        return make_unique<ImplFor<McsMutex, LinkedQueue>>(workers);
+    }
+    return make_unique<ImplFor<std::mutex, LinkedQueue>>(workers);
+}
+
+/**
+ * 构造函数：按互斥类型创建队列并启动对应数量的后台线程
+ */
+WorkQueue::WorkQueue(MutexType m, size_t workers) : pImpl(makeImpl(m, ElasticPolicy{workers, workers})) {}
+
+WorkQueue::WorkQueue(MutexType m, const ElasticPolicy &policy) : pImpl(makeImpl(m, policy)) {}
+
+WorkQueue::~WorkQueue() = default;
+
+bool WorkQueue::submit(Task &&task, Priority priority, bool tryOnly) {
+    return pImpl->submit(move(task), priority, tryOnly);
+}
+
+void WorkQueue::submitBatch(vector<Task> &&tasks) {
+    pImpl->submitBatch(move(tasks));
+}
+
+TimerHandle WorkQueue::schedule(chrono::steady_clock::time_point when, Task &&task,
+                                chrono::steady_clock::duration period) {
+    return pImpl->schedule(when, move(task), period);
+}
+
+bool WorkQueue::runPendingTask() {
+    return pImpl->runPendingTask();
+}
+
+size_t WorkQueue::workerCount() const {
+    return pImpl->base().workerCount();
+}
+
+size_t WorkQueue::liveWorkers() const {
+    return pImpl->base().liveWorkers();
+}
+
+void WorkQueue::setIdlePolicy(const IdlePolicy &policy) {
+    pImpl->base().setIdlePolicy(policy);
+}
+
+IdlePolicy WorkQueue::idlePolicy() const {
+    return pImpl->base().idlePolicy();
+}
+
+bool WorkQueue::setAffinity(const AffinityPolicy &policy) {
+    return pImpl->base().setAffinity(policy);
+}
+
+unsigned WorkQueue::workerNode(size_t worker) const {
+    return pImpl->base().workerNode(worker);
+}
+
+void WorkQueue::setCapacity(size_t capacity, OverflowPolicy policy) {
+    pImpl->base().setCapacity(capacity, policy);
+}
+
+size_t WorkQueue::droppedTasks() const {
+    return pImpl->base().droppedTasks();
+}
+
+void WorkQueue::setExceptionHandler(function<void(exception_ptr)> handler) {
+    pImpl->base().setExceptionHandler(move(handler));
 }
 
 /**
  * 对外提供的停止接口，内部委托给基类实现（仅取消通知，不直接销毁线程）
  */
 void WorkQueue::stopWorkQueue() {
-    stop();
-}
\ No newline at end of file
+    pImpl->stopWorkQueue();
+}
+
+bool WorkQueue::shutdown(ShutdownMode mode, chrono::steady_clock::duration timeout) {
+    return pImpl->shutdown(mode, timeout);
+}
+
+bool WorkQueue::isShutdown() const {
+    return pImpl->base().isShutdown();
+}
+
+WorkQueueStats WorkQueue::stats() const {
+    return pImpl->stats();
+}
@@ -0,0 +1,621 @@
+#include "workqueue.h"
+#include "future.h"
+#include "parallel.h"
+#include "strand.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lmc;
+using namespace std;
+
+/**
+ * Thread / WorkQueue 压力与竞争测试
+ *
+ * 针对启动/停止/关闭协议中容易出现的丢失唤醒与关闭挂起，每个场景对每种 MutexType 运行若干轮：
+ * - shutdown-race: 多个生产者持续 addTask（任务中再提交子任务），控制线程在随机时刻反复 stopWorkQueue()，
+ *   随后与另一个线程同时 shutdown()（随机 Drain / Cancel），最后析构队列；弹性线程数 {1, 4}，
+ *   期间后台线程不断增减。检查：所有 future 最终就绪，得到结果或 broken_promise，执行次数与结果数一致；
+ *   Drain 时后台线程提交的子任务全部执行
+ * - lost-wakeup: 单个提交者在随机间隔（让后台线程进入阻塞）后提交任务并限时等待完成，
+ *   超时即为丢失唤醒；一半的任务由后台线程在任务中提交
+ * - strand: 多个生产者向共享执行器上的多个 Strand 提交带序号的任务，检查每个 Strand 内部互斥且按提交顺序执行
+ * - periodic-drain: 执行时间超过周期的周期任务（始终处于排队或执行中），分别以 shutdown(Drain, 限时) 与析构关闭，
+ *   检查关闭按时返回且之后不再执行
+ * - periodic-cancel: 到期的周期任务排在高优先级任务之后、尚未开始时 cancel()，检查 cancel() 返回 true 且任务不再执行
+ * - helper-drain: 另一线程通过 runPendingTask() 执行任务期间 shutdown(Drain)，检查关闭等该任务执行完、
+ *   接受其提交的子任务并执行，返回 true
+ * - parallel-dropped: 在已关闭的队列、容量为 1 的 Reject / DropOldest 队列上执行 parallelFor / parallelReduce，
+ *   被队列丢弃的部分由调用线程执行，检查按时返回且每个下标恰好执行一次
+ * - future-unwrap: then() 的续延返回无效的 Future（外层 Future 得到 no_state，后台线程不受影响），
+ *   以及返回稍后在其他任务中完成的 Future
+ * - task-args: addTask / async / addTasks 的参数传递：只接受左值引用的 f 得到保存的副本，只可移动的参数以右值传入
+ *
+ * 每行输出 scenario,backend,rounds,tasks,tasks_per_sec,dropped,result（CSV），任一检查失败时进程返回 1；
+ * 单个场景超过 --timeout 秒（默认 120）视为挂起，打印场景名后 abort()。
+ * 随机的提交间隔与关闭时刻由 --seed（默认 1）决定，失败时以同一 seed 重现调度；--quick 缩小规模用于 ctest。
+ * 以 -DLMC_ENABLE_TSAN=ON 配置 CMake 时整个工程以 ThreadSanitizer 编译。
+ */
+
+struct Options {
+    bool quick = false;
+    unsigned seed = 1;
+    unsigned timeoutSec = 120;
+};
+
+struct Outcome {
+    size_t tasks = 0;     // 已执行的任务数
+    size_t dropped = 0;   // 得到 broken_promise（被丢弃）的任务数
+    int64_t elapsedNs = 0;
+    string failure;       // 为空表示通过
+};
+
+struct Backend {
+    const char *name;
+    MutexType type;
+};
+
+static const Backend backends[] = {
+    {"none", MutexType::None},
+    {"spin", MutexType::Spin},
+    {"mutex", MutexType::Mutex},
+    {"lockfree", MutexType::LockFree},
+    {"ticket", MutexType::Ticket},
+    {"mcs", MutexType::Mcs},
+};
+
+static int64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Watchdog - 场景超时即判定为挂起：打印场景名并 abort()
+ */
+class Watchdog {
+public:
+    explicit Watchdog(unsigned timeoutSec) : timeout(timeoutSec), done(false), thread([this] { watch(); }) {}
+
+    ~Watchdog() {
+        {
+            lock_guard<mutex> lock(m);
+            done = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+
+    void enter(const string &scenario) {
+        lock_guard<mutex> lock(m);
+        current = scenario;
+        deadline = chrono::steady_clock::now() + chrono::seconds(timeout);
+        cv.notify_all();
+    }
+
+private:
+    void watch() {
+        unique_lock<mutex> lock(m);
+        while (!done) {
+            if (current.empty()) {
+                cv.wait(lock);
+                continue;
+            }
+            auto until = deadline;
+            if (cv.wait_until(lock, until) == cv_status::timeout && !done && deadline == until) {
+                fprintf(stderr, "HANG: %s did not finish within %us\n", current.c_str(), timeout);
+                fflush(stderr);
+                abort();
+            }
+        }
+    }
+
+    unsigned timeout;
+    mutex m;
+    condition_variable cv;
+    bool done;
+    string current;
+    chrono::steady_clock::time_point deadline;
+    std::thread thread;
+};
+
+/**
+ * 等待 future 就绪并分类，超时（队列析构之后仍未就绪）直接判定失败
+ */
+template <typename T>
+static bool settle(future<T> &f, Outcome &out, size_t &values) {
+    if (f.wait_for(chrono::seconds(10)) != future_status::ready) {
+        out.failure = "future never became ready";
+        return false;
+    }
+    try {
+        f.get();
+        ++values;
+    } catch (const future_error &e) {
+        if (e.code() != future_errc::broken_promise) {
+            out.failure = string("unexpected future_error: ") + e.what();
+            return false;
+        }
+        ++out.dropped;
+    }
+    return true;
+}
+
+static Outcome shutdownRace(MutexType type, size_t rounds, size_t perProducer, mt19937 &rng) {
+    const size_t producers = type == MutexType::None ? 1 : 4;
+    Outcome out;
+    int64_t begin = nowNs();
+
+    for (size_t round = 0; round < rounds && out.failure.empty(); ++round) {
+        ElasticPolicy policy{1, 4};
+        policy.growAfter = chrono::milliseconds(1);
+        policy.keepAlive = chrono::milliseconds(2);
+        auto queue = make_unique<WorkQueue>(type, policy);
+
+        const bool drain = rng() % 2 == 0;
+        const unsigned stopAfterUs = rng() % 2000;
+        const unsigned stops = rng() % 4;
+        atomic<size_t> executed(0);
+        atomic<size_t> childrenSpawned(0);
+        atomic<size_t> childrenRun(0);
+        atomic<bool> go(false);
+        vector<vector<future<size_t>>> results(producers);
+
+        vector<thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                while (!go.load(memory_order_acquire))
+                    this_thread::yield();
+                WorkQueue &q = *queue;
+                results[p].reserve(perProducer);
+                for (size_t i = 0; i < perProducer; ++i) {
+                    results[p].push_back(q.addTask([&q, &executed, &childrenSpawned, &childrenRun, i] {
+                        if (i % 16 == 0) {
+                            childrenSpawned.fetch_add(1, memory_order_relaxed);
+                            q.post([&childrenRun] { childrenRun.fetch_add(1, memory_order_relaxed); });
+                        }
+                        executed.fetch_add(1, memory_order_relaxed);
+                        return i;
+                    }));
+                }
+            });
+        }
+
+        // 控制线程：随机时刻反复停止唤醒，随后与另一个线程同时关闭
+        threads.emplace_back([&] {
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            for (unsigned s = 0; s < stops; ++s) {
+                this_thread::sleep_for(chrono::microseconds(stopAfterUs / (stops + 1)));
+                queue->stopWorkQueue();
+            }
+            this_thread::sleep_for(chrono::microseconds(stopAfterUs / (stops + 1)));
+            queue->shutdown(drain ? ShutdownMode::Drain : ShutdownMode::Cancel);
+        });
+        threads.emplace_back([&] {
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            this_thread::sleep_for(chrono::microseconds(stopAfterUs));
+            queue->shutdown(ShutdownMode::Drain);
+        });
+
+        go.store(true, memory_order_release);
+        for (auto &t : threads)
+            t.join();
+        queue.reset();
+
+        size_t values = 0;
+        for (auto &list : results)
+            for (auto &f : list)
+                if (!settle(f, out, values))
+                    return out;
+
+        if (executed.load() != values)
+            out.failure = "executed " + to_string(executed.load()) + " tasks but " + to_string(values) + " results";
+        else if (drain && childrenRun.load() != childrenSpawned.load())
+            out.failure = "drain lost child tasks: " + to_string(childrenRun.load()) + "/" +
+                          to_string(childrenSpawned.load());
+        out.tasks += values + childrenRun.load();
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome lostWakeup(MutexType type, size_t rounds, mt19937 &rng) {
+    Outcome out;
+    WorkQueue queue(type, 2);
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds; ++i) {
+        // 间隔足够长时后台线程已越过自旋/让出阶段进入阻塞，此时的提交必须唤醒它
+        this_thread::sleep_for(chrono::microseconds(rng() % 300));
+
+        future<void> f;
+        if (i % 2 == 0) {
+            f = queue.addTask([] {});
+        } else {
+            auto p = make_shared<promise<void>>();
+            f = p->get_future();
+            queue.post([&queue, p] { queue.post([p] { p->set_value(); }); });
+        }
+
+        if (f.wait_for(chrono::seconds(2)) != future_status::ready) {
+            out.failure = "lost wakeup at round " + to_string(i);
+            f.wait();
+        }
+        ++out.tasks;
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome strandOrder(MutexType type, size_t perProducer, mt19937 &rng) {
+    const size_t strandCount = 8;
+    const size_t producers = type == MutexType::None ? 1 : 4;
+    Outcome out;
+
+    WorkQueue pool(type, ElasticPolicy{2, 4});
+    vector<unique_ptr<Strand<WorkQueue>>> strands;
+    for (size_t s = 0; s < strandCount; ++s)
+        strands.emplace_back(new Strand<WorkQueue>(pool, 1 + rng() % 8));
+
+    // 只在所属 Strand 的任务中访问，不加锁；inside 检查互斥，last 检查每个生产者的提交顺序
+    struct Track {
+        atomic<int> inside{0};
+        vector<size_t> last;
+    };
+    vector<Track> tracks(strandCount);
+    for (auto &t : tracks)
+        t.last.assign(producers, 0);
+    atomic<size_t> violations(0);
+    atomic<size_t> executed(0);
+
+    vector<unsigned> seeds;
+    for (size_t p = 0; p < producers; ++p)
+        seeds.push_back(rng());
+
+    int64_t begin = nowNs();
+    vector<thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            mt19937 local(seeds[p]);
+            for (size_t i = 1; i <= perProducer; ++i) {
+                size_t s = local() % strandCount;
+                strands[s]->post([&, s, p, i] {
+                    Track &t = tracks[s];
+                    if (t.inside.fetch_add(1, memory_order_acq_rel) != 0)
+                        violations.fetch_add(1);
+                    if (t.last[p] >= i)
+                        violations.fetch_add(1);
+                    t.last[p] = i;
+                    executed.fetch_add(1, memory_order_relaxed);
+                    t.inside.fetch_sub(1, memory_order_acq_rel);
+                });
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    for (auto &s : strands)
+        s->addTask([] {}).get();
+    out.elapsedNs = nowNs() - begin;
+
+    out.tasks = executed.load();
+    if (out.tasks != producers * perProducer)
+        out.failure = "strand executed " + to_string(out.tasks) + "/" + to_string(producers * perProducer);
+    else if (violations.load() != 0)
+        out.failure = to_string(violations.load()) + " ordering/exclusion violations";
+    return out;
+}
+
+static Outcome periodicDrain(MutexType type, size_t rounds) {
+    Outcome out;
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        auto runs = make_shared<atomic<size_t>>(0);
+        auto body = [runs] {
+            this_thread::sleep_for(chrono::milliseconds(3));
+            runs->fetch_add(1);
+        };
+
+        size_t before = 0;
+        int64_t closeNs = 0;
+        bool drained = true;
+        {
+            WorkQueue queue(type, 2);
+            queue.addPeriodic(chrono::milliseconds(1), body);
+            this_thread::sleep_for(chrono::milliseconds(10));
+
+            int64_t t0 = nowNs();
+            if (i % 2 == 0) {
+                drained = queue.shutdown(ShutdownMode::Drain, chrono::seconds(3));
+                closeNs = nowNs() - t0;
+                before = runs->load();
+            }
+            // 奇数轮由析构函数以不限时的 Drain 关闭
+        }
+        if (i % 2 != 0)
+            before = runs->load();
+
+        this_thread::sleep_for(chrono::milliseconds(10));
+        size_t after = runs->load();
+        out.tasks += after;
+
+        if (!drained || closeNs > chrono::duration_cast<chrono::nanoseconds>(chrono::seconds(1)).count())
+            out.failure = "shutdown(Drain) did not finish the periodic task in time at round " + to_string(i);
+        else if (after != before)
+            out.failure = to_string(after - before) + " periodic runs after shutdown at round " + to_string(i);
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome periodicCancel(MutexType type, size_t rounds) {
+    Outcome out;
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        WorkQueue queue(type, 1);
+        promise<void> gateA, gateB, startedB;
+        shared_future<void> openA = gateA.get_future().share();
+        shared_future<void> openB = gateB.get_future().share();
+
+        // 唯一的后台线程先被 A 占住，其间周期任务到期；A 结束后到期的周期任务入队，
+        // 但高优先级的 B 先被取出，周期任务在 B 执行期间处于“已入队、未开始”的状态
+        queue.post([openA] { openA.wait(); });
+        auto runs = make_shared<atomic<size_t>>(0);
+        TimerHandle handle = queue.addPeriodic(chrono::milliseconds(1), [runs] { runs->fetch_add(1); });
+        this_thread::sleep_for(chrono::milliseconds(5));
+        queue.post(Priority::High, [openB, &startedB] {
+            startedB.set_value();
+            openB.wait();
+        });
+        gateA.set_value();
+        startedB.get_future().wait();
+
+        bool cancelled = handle.cancel();
+        gateB.set_value();
+        this_thread::sleep_for(chrono::milliseconds(10));
+        queue.shutdown();
+        out.tasks += 2 + runs->load();
+
+        if (!cancelled)
+            out.failure = "cancel() of a queued periodic task returned false at round " + to_string(i);
+        else if (runs->load() != 0)
+            out.failure = "cancelled periodic task ran " + to_string(runs->load()) + " times at round " + to_string(i);
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome helperDrain(MutexType type, size_t rounds) {
+    Outcome out;
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        WorkQueue queue(type, 1);
+        promise<void> gate, started;
+        shared_future<void> open = gate.get_future().share();
+        atomic<bool> finished(false), childRan(false);
+
+        // 唯一的后台线程把 T 放入自己的本地队列后阻塞，T 只能由帮忙执行的线程窃取执行
+        queue.post([&, open] {
+            queue.post([&] {
+                started.set_value();
+                this_thread::sleep_for(chrono::milliseconds(30));
+                queue.post([&] { childRan.store(true); });
+                finished.store(true);
+            });
+            open.wait();
+        });
+        thread helper([&] {
+            while (!queue.runPendingTask())
+                this_thread::yield();
+        });
+
+        started.get_future().wait();
+        gate.set_value();
+        bool complete = queue.shutdown(ShutdownMode::Drain);
+        bool finishedAtReturn = finished.load();
+        helper.join();
+        out.tasks += 3;
+
+        if (!complete)
+            out.failure = "shutdown(Drain) reported dropped tasks at round " + to_string(i);
+        else if (!finishedAtReturn)
+            out.failure = "shutdown(Drain) returned while a helper was still running a task at round " + to_string(i);
+        else if (!childRan.load())
+            out.failure = "child posted by a helper-run task was dropped at round " + to_string(i);
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome parallelDropped(MutexType type, size_t rounds) {
+    const int n = 1000;
+    Outcome out;
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        WorkQueue queue(type, 2);
+        const char *mode = "closed";
+        switch (i % 3) {
+            case 0:
+                queue.shutdown();
+            break;
+            case 1:
+                mode = "reject";
+                queue.setCapacity(1, OverflowPolicy::Reject);
+            break;
+            default:
+                mode = "drop-oldest";
+                queue.setCapacity(1, OverflowPolicy::DropOldest);
+            break;
+        }
+
+        vector<atomic<int>> hits(n);
+        parallelFor(queue, 0, n, 10, [&](int k) {
+            hits[static_cast<size_t>(k)].fetch_add(1, memory_order_relaxed);
+            this_thread::sleep_for(chrono::microseconds(10));
+        });
+        long long sum = parallelReduce(queue, 0, n, 7, 0LL, [](int k) { return static_cast<long long>(k); },
+                                       [](long long a, long long b) { return a + b; });
+        out.tasks += 2 * n;
+
+        for (int k = 0; k < n && out.failure.empty(); ++k) {
+            if (hits[static_cast<size_t>(k)].load() != 1)
+                out.failure = string(mode) + ": index " + to_string(k) + " ran " +
+                              to_string(hits[static_cast<size_t>(k)].load()) + " times";
+        }
+        if (out.failure.empty() && sum != static_cast<long long>(n) * (n - 1) / 2)
+            out.failure = string(mode) + ": parallelReduce returned " + to_string(sum);
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome futureUnwrap(MutexType type, size_t rounds) {
+    Outcome out;
+    WorkQueue queue(type, 2);
+    int64_t begin = nowNs();
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        Future<int> invalid = makeReadyFuture(1).then(queue, [](int) { return Future<int>(); });
+        try {
+            invalid.get();
+            out.failure = "invalid inner future produced a value";
+        } catch (const future_error &e) {
+            if (e.code() != future_errc::no_state)
+                out.failure = string("invalid inner future: unexpected ") + e.what();
+        }
+
+        Future<int> nested = makeReadyFuture(static_cast<int>(i)).then(queue, [&queue](int v) {
+            return queue.async([v] { return v + 1; });
+        });
+        int v = nested.get();
+        if (out.failure.empty() && v != static_cast<int>(i) + 1)
+            out.failure = "nested future returned " + to_string(v);
+        out.tasks += 3;
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static Outcome taskArgs(MutexType type, size_t rounds) {
+    Outcome out;
+    WorkQueue queue(type, 2);
+    int64_t begin = nowNs();
+
+    auto byRef = [](int &x) { return ++x; };
+    auto byValue = [](unique_ptr<int> p) { return *p; };
+    vector<int> items{1, 2, 3};
+
+    for (size_t i = 0; i < rounds && out.failure.empty(); ++i) {
+        int v = static_cast<int>(i);
+        int a = queue.addTask(byRef, v).get();
+        int b = queue.async(byRef, v).get();
+        int c = queue.addTask(byValue, make_unique<int>(v)).get();
+        auto fs = queue.addTasks(items.begin(), items.end(), byRef);
+        int d = 0;
+        for (auto &f : fs)
+            d += f.get();
+        out.tasks += 3 + fs.size();
+
+        if (a != v + 1 || b != v + 1 || c != v || d != 9)
+            out.failure = "unexpected results at round " + to_string(i);
+        else if (v != static_cast<int>(i) || items[0] != 1)
+            out.failure = "task modified the caller's argument at round " + to_string(i);
+    }
+
+    out.elapsedNs = nowNs() - begin;
+    return out;
+}
+
+static bool report(const char *scenario, const char *backend, size_t rounds, const Outcome &o) {
+    double rate = static_cast<double>(o.tasks) * 1e9 / static_cast<double>(o.elapsedNs > 0 ? o.elapsedNs : 1);
+    printf("%s,%s,%zu,%zu,%.0f,%zu,%s\n", scenario, backend, rounds, o.tasks, rate, o.dropped,
+           o.failure.empty() ? "ok" : "FAIL");
+    if (!o.failure.empty())
+        fprintf(stderr, "%s/%s: %s\n", scenario, backend, o.failure.c_str());
+    fflush(stdout);
+    return o.failure.empty();
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            opt.quick = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opt.seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            opt.timeoutSec = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else {
+            fprintf(stderr, "用法: %s [--quick] [--seed N] [--timeout 秒]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const size_t raceRounds = opt.quick ? 6 : 40;
+    const size_t perProducer = opt.quick ? 2000 : 20000;
+    const size_t wakeRounds = opt.quick ? 200 : 2000;
+    const size_t periodicRounds = opt.quick ? 4 : 20;
+    const size_t parallelRounds = opt.quick ? 3 : 30;
+    const size_t unwrapRounds = opt.quick ? 100 : 1000;
+
+    printf("# seed=%u\n", opt.seed);
+    printf("scenario,backend,rounds,tasks,tasks_per_sec,dropped,result\n");
+
+    Watchdog watchdog(opt.timeoutSec);
+    bool ok = true;
+    unsigned scenarioSeed = opt.seed;
+    for (const Backend &b : backends) {
+        mt19937 rng(scenarioSeed++);
+
+        watchdog.enter(string("shutdown-race/") + b.name);
+        ok &= report("shutdown-race", b.name, raceRounds, shutdownRace(b.type, raceRounds, perProducer, rng));
+
+        watchdog.enter(string("lost-wakeup/") + b.name);
+        ok &= report("lost-wakeup", b.name, wakeRounds, lostWakeup(b.type, wakeRounds, rng));
+
+        watchdog.enter(string("strand/") + b.name);
+        ok &= report("strand", b.name, 1, strandOrder(b.type, perProducer, rng));
+
+        watchdog.enter(string("periodic-drain/") + b.name);
+        ok &= report("periodic-drain", b.name, periodicRounds, periodicDrain(b.type, periodicRounds));
+
+        watchdog.enter(string("periodic-cancel/") + b.name);
+        ok &= report("periodic-cancel", b.name, periodicRounds, periodicCancel(b.type, periodicRounds));
+
+        watchdog.enter(string("helper-drain/") + b.name);
+        ok &= report("helper-drain", b.name, periodicRounds, helperDrain(b.type, periodicRounds));
+
+        watchdog.enter(string("parallel-dropped/") + b.name);
+        ok &= report("parallel-dropped", b.name, parallelRounds, parallelDropped(b.type, parallelRounds));
+
+        watchdog.enter(string("future-unwrap/") + b.name);
+        ok &= report("future-unwrap", b.name, unwrapRounds, futureUnwrap(b.type, unwrapRounds));
+
+        watchdog.enter(string("task-args/") + b.name);
+        ok &= report("task-args", b.name, unwrapRounds, taskArgs(b.type, unwrapRounds));
+    }
+    return ok ? 0 : 1;
+}
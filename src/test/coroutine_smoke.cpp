@@ -0,0 +1,112 @@
+#include "workqueue.h"
+#include "coroutine.h"
+#include "strand.h"
+
+#include <cstdio>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace lmc;
+using namespace std;
+
+/**
+ * C++20 协程冒烟测试：以 C++20 编译（CMake 中该目标总是如此），驱动 CoTask、co_await queue.schedule() 与 spawn()
+ *
+ * - schedule() 把协程转移到后台线程；spawn() 返回结果的 Future
+ * - 嵌套的 CoTask 与 co_await Future（queue.async 的结果）
+ * - 协程中的异常传到 spawn() 的 Future；co_await 已关闭队列的 schedule() 抛出 broken_promise
+ * - co_await strand.schedule() 在 Strand 中恢复
+ *
+ * 任一检查失败时返回 1；编译器或标准库不支持协程（未定义 LMC_HAS_COROUTINES）时返回 77，ctest 记为跳过。
+ */
+
+#ifdef LMC_HAS_COROUTINES
+
+static int failures = 0;
+
+static void check(bool ok, const string &what) {
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what.c_str());
+        ++failures;
+    }
+}
+
+static CoTask<int> add(WorkQueue &queue, int a, int b) {
+    co_await queue.schedule();
+    int sum = co_await queue.async([a, b] { return a + b; });
+    co_return sum;
+}
+
+static CoTask<int> answer(WorkQueue &queue, thread::id caller, bool *offCaller) {
+    co_await queue.schedule();
+    *offCaller = this_thread::get_id() != caller;
+    int x = co_await add(queue, 20, 1);
+    co_return x * 2;
+}
+
+static CoTask<void> fail(WorkQueue &queue) {
+    co_await queue.schedule();
+    throw runtime_error("expected");
+}
+
+static CoTask<int> hop(WorkQueue &queue, WorkQueue &closed) {
+    co_await queue.schedule();
+    try {
+        co_await closed.schedule();
+    } catch (const future_error &e) {
+        co_return e.code() == future_errc::broken_promise ? 1 : 0;
+    }
+    co_return 0;
+}
+
+static CoTask<int> onStrand(Strand<WorkQueue> &strand, int *counter) {
+    co_await strand.schedule();
+    co_return ++*counter;
+}
+
+int main() {
+    WorkQueue queue(MutexType::Mutex, 2);
+
+    bool offCaller = false;
+    check(spawn(queue, answer(queue, this_thread::get_id(), &offCaller)).get() == 42, "spawn(answer) != 42");
+    check(offCaller, "schedule() did not resume on a worker thread");
+
+    try {
+        spawn(queue, fail(queue)).get();
+        check(false, "exception was not propagated");
+    } catch (const runtime_error &) {
+    }
+
+    WorkQueue closed(MutexType::Mutex, 1);
+    closed.shutdown();
+    check(spawn(queue, hop(queue, closed)).get() == 1, "schedule() on a closed queue did not throw broken_promise");
+
+    try {
+        spawn(closed, add(queue, 1, 2)).get();
+        check(false, "spawn() on a closed queue produced a value");
+    } catch (const future_error &e) {
+        check(e.code() == future_errc::broken_promise, "spawn() on a closed queue: unexpected error");
+    }
+
+    Strand<WorkQueue> strand(queue);
+    int counter = 0;
+    int last = 0;
+    for (int i = 0; i < 100; ++i)
+        last = spawn(queue, onStrand(strand, &counter)).get();
+    check(last == 100 && counter == 100, "strand schedule() lost resumptions");
+
+    if (failures == 0)
+        printf("coroutine smoke: ok\n");
+    return failures == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+    printf("coroutine smoke: skipped (no C++20 coroutine support)\n");
+    return 77;
+}
+
+#endif
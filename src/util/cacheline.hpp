@@ -0,0 +1,33 @@
+#ifndef CACHELINE_HPP_
+#define CACHELINE_HPP_
+
+#include <cstddef>
+#include <new>
+
+namespace lmc {
+
+/**
+ * CacheLineSize - 缓存行大小（伪共享的最小间隔）
+ *
+ * 被不同线程频繁写入的数据应当按该值对齐/填充，避免落在同一缓存行上产生伪共享。
+ * 标准库提供 std::hardware_destructive_interference_size 时使用该值；
+ * GCC 的该值随 -mtune 变化，出现在头文件的类布局中会造成不同编译单元 ABI 不一致，
+ * 因此 GCC 下与其他缺少该常量的实现一样固定为 64。
+ */
+#if defined(__cpp_lib_hardware_interference_size) && !defined(__GNUC__)
+constexpr std::size_t CacheLineSize = std::hardware_destructive_interference_size;
+#else
+constexpr std::size_t CacheLineSize = 64;
+#endif
+
+/**
+ * CacheAligned - 独占缓存行的包装：T 对齐到缓存行且尺寸补齐为缓存行的整数倍，
+ * 数组中相邻元素不会互相伪共享
+ */
+template <typename T>
+struct alignas(CacheLineSize) CacheAligned {
+    T value;
+};
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CPUPAUSE_HPP_
+#define CPUPAUSE_HPP_
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LMC_CPU_PAUSE() _mm_pause()
+#elif defined(_M_ARM64) || defined(_M_ARM)
+#include <intrin.h>
+#define LMC_CPU_PAUSE() __yield()
+#elif defined(__aarch64__) || defined(__arm__)
+#define LMC_CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define LMC_CPU_PAUSE() ((void)0)
+#endif
+
+namespace lmc {
+
+/**
+ * cpuPause - 自旋等待时的 CPU 提示指令
+ *
+ * x86 上为 pause，ARM 上为 yield：降低自旋循环的功耗与流水线冲刷，
+ * 并在超线程场景下把执行资源让给同一物理核上的另一个逻辑核。
+ */
+inline void cpuPause() {
+    LMC_CPU_PAUSE();
+}
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef HISTOGRAM_HPP_
+#define HISTOGRAM_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lmc {
+
+/**
+ * 对数-线性分桶（HDR 风格）：每个 2 的幂区间再线性划分为 2^SubBits 个桶，
+ * 相对误差不超过 1/2^SubBits（12.5%），桶数与取值范围的对数成正比。
+ * 取值单位为纳秒，[0, 8) 精确记录，超过 2^MaxExp 纳秒（约 18 分钟）的值计入最后一个桶。
+ */
+namespace hist {
+
+constexpr unsigned SubBits = 3;
+constexpr unsigned SubCount = 1u << SubBits;
+constexpr unsigned MaxExp = 40;
+constexpr size_t Buckets = (MaxExp - SubBits + 2) * SubCount;
+
+inline unsigned highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned e = 0;
+    while (v >>= 1)
+        ++e;
+    return e;
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#endif
+}
+
+inline size_t bucketOf(uint64_t v) {
+    if (v < SubCount)
+        return static_cast<size_t>(v);
+    unsigned e = highestBit(v);
+    if (e > MaxExp)
+        return Buckets - 1;
+    size_t sub = static_cast<size_t>((v >> (e - SubBits)) & (SubCount - 1));
+    return (e - SubBits + 1) * SubCount + sub;
+}
+
+/**
+ * 桶 idx 覆盖的最大值（含）
+ */
+inline uint64_t bucketUpper(size_t idx) {
+    if (idx < SubCount)
+        return idx;
+    unsigned e = static_cast<unsigned>(idx / SubCount) + SubBits - 1;
+    uint64_t sub = idx % SubCount;
+    uint64_t width = uint64_t(1) << (e - SubBits);
+    return ((SubCount + sub) << (e - SubBits)) + width - 1;
+}
+}
+
+/**
+ * HistogramSnapshot - 直方图在某一时刻的副本，可合并多个线程的结果
+ */
+struct HistogramSnapshot {
+    std::array<uint64_t, hist::Buckets> counts{};
+    uint64_t count = 0;
+    uint64_t sum = 0;   // 纳秒
+    uint64_t max = 0;   // 纳秒
+
+    HistogramSnapshot &operator+=(const HistogramSnapshot &o) {
+        for (size_t i = 0; i < hist::Buckets; ++i)
+            counts[i] += o.counts[i];
+        count += o.count;
+        sum += o.sum;
+        if (o.max > max)
+            max = o.max;
+        return *this;
+    }
+
+    /**
+     * 平均值（纳秒），没有样本时为 0
+     */
+    double mean() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+    }
+
+    /**
+     * q 分位数（q 取 [0, 1]，例如 0.99）的近似值（纳秒）：返回所在桶的上界，不超过最大值
+     */
+    uint64_t percentile(double q) const {
+        if (count == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count));
+        if (rank >= count)
+            rank = count - 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < hist::Buckets; ++i) {
+            seen += counts[i];
+            if (seen > rank) {
+                uint64_t upper = hist::bucketUpper(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
+
+/**
+ * LatencyHistogram - 单写者的延迟直方图
+ *
+ * 只允许一个线程调用 record()（例如每个后台线程一个），写入为 relaxed 的读-加-写，
+ * 不使用原子读-改-写指令；任意线程可随时调用 snapshot()，得到的是近似一致的副本。
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() {
+        for (auto &c : counts)
+            c.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t ns) {
+        bump(counts[hist::bucketOf(ns)], 1);
+        bump(count, 1);
+        bump(sum, ns);
+        if (ns > max.load(std::memory_order_relaxed))
+            max.store(ns, std::memory_order_relaxed);
+    }
+
+    void snapshot(HistogramSnapshot &out) const {
+        for (size_t i = 0; i < hist::Buckets; ++i)
+            out.counts[i] = counts[i].load(std::memory_order_relaxed);
+        out.count = count.load(std::memory_order_relaxed);
+        out.sum = sum.load(std::memory_order_relaxed);
+        out.max = max.load(std::memory_order_relaxed);
+    }
+
+private:
+    static void bump(std::atomic<uint64_t> &c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> counts[hist::Buckets];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef MCSMUTEX_HPP_
+#define MCSMUTEX_HPP_
+
+#include "cacheline.hpp"
+#include "cpupause.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace lmc {
+
+/**
+ * McsMutex - MCS 队列自旋锁（公平，适合高争用）
+ *
+ * 特点：
+ * - 每个等待者把自己的队列节点挂到链表尾部（一次 exchange），然后只在自己的节点上自旋；
+ *   解锁时只通知直接后继，每次交接只有一条缓存行在两个核之间传递，争用者再多也不会形成广播风暴
+ * - 严格 FIFO
+ * - 队列节点取自线程本地的空闲链表，接口与 std::mutex 一致（lock()/unlock() 无需传入节点），
+ *   同一线程可同时持有多把 McsMutex，解锁顺序不限
+ * - 长时间未轮到时改为 yield（前驱线程可能已被抢占）
+ */
+class alignas(CacheLineSize) McsMutex {
+public:
+    static constexpr unsigned SpinLimit = 256;
+
+    McsMutex() : tail_(nullptr), owner_(nullptr) {}
+
+    McsMutex(const McsMutex &) = delete;
+    McsMutex &operator=(const McsMutex &) = delete;
+
+    inline void lock() {
+        Node *me = acquireNode();
+        me->next.store(nullptr, std::memory_order_relaxed);
+        me->locked.store(true, std::memory_order_relaxed);
+
+        Node *pred = tail_.exchange(me, std::memory_order_acq_rel);
+        if (pred) {
+            pred->next.store(me, std::memory_order_release);
+            unsigned spins = 0;
+            while (me->locked.load(std::memory_order_acquire)) {
+                if (++spins < SpinLimit)
+                    cpuPause();
+                else
+                    std::this_thread::yield();
+            }
+        }
+        owner_ = me;
+    }
+
+    inline bool try_lock() {
+        Node *me = acquireNode();
+        me->next.store(nullptr, std::memory_order_relaxed);
+        Node *expect = nullptr;
+        if (!tail_.compare_exchange_strong(expect, me, std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+            releaseNode(me);
+            return false;
+        }
+        owner_ = me;
+        return true;
+    }
+
+    inline void unlock() {
+        Node *me = owner_;
+        Node *succ = me->next.load(std::memory_order_acquire);
+        if (!succ) {
+            // 没有可见的后继：若自己仍是队尾，直接清空队列
+            Node *expect = me;
+            if (tail_.compare_exchange_strong(expect, nullptr, std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+                releaseNode(me);
+                return;
+            }
+            // 后继已经 exchange 了 tail_ 但尚未链接到本节点，等待其完成
+            while (!(succ = me->next.load(std::memory_order_acquire)))
+                cpuPause();
+        }
+        succ->locked.store(false, std::memory_order_release);
+        releaseNode(me);
+    }
+
+private:
+    struct alignas(CacheLineSize) Node {
+        std::atomic<Node *> next{nullptr};
+        std::atomic<bool> locked{false};
+        Node *nextFree = nullptr;
+    };
+
+    /**
+     * 线程本地的节点空闲链表，线程退出时释放
+     */
+    struct NodeCache {
+        Node *free = nullptr;
+
+        ~NodeCache() {
+            while (free) {
+                Node *n = free;
+                free = n->nextFree;
+                delete n;
+            }
+        }
+    };
+
+    static NodeCache &nodeCache() {
+        thread_local NodeCache cache;
+        return cache;
+    }
+
+    static Node *acquireNode() {
+        NodeCache &c = nodeCache();
+        if (!c.free)
+            return new Node();
+        Node *n = c.free;
+        c.free = n->nextFree;
+        return n;
+    }
+
+    static void releaseNode(Node *n) {
+        NodeCache &c = nodeCache();
+        n->nextFree = c.free;
+        c.free = n;
+    }
+
+    std::atomic<Node *> tail_;
+    Node *owner_; // 持锁者的节点，只由持锁者读写
+};
+}
+
+#endif
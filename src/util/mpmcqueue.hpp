@@ -0,0 +1,124 @@
+#ifndef MPMCQUEUE_HPP_
+#define MPMCQUEUE_HPP_
+
+#include "cacheline.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lmc {
+
+/**
+ * MpmcQueue - 有界多生产者多消费者无锁环形队列（Dmitry Vyukov 算法）
+ *
+ * 特点：
+ * - 容量在构造时确定（向上取整为 2 的幂），所有槽位预先分配，push/pop 不做任何内存分配
+ * - 每个槽位带有一个序号 seq，生产者/消费者通过 CAS 推进各自的位置计数后，
+ *   根据 seq 判断槽位是否可写/可读，不需要任何锁
+ * - 槽位与两个位置计数均按缓存行对齐，避免相邻槽位或生产者/消费者之间的伪共享
+ *
+ * 约束：
+ * - 队列满时 push() 返回 false，队列空时 pop() 返回 false，由调用者决定重试策略
+ */
+template <typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i)
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    ~MpmcQueue() {
+        T v;
+        while (pop(v)) {}
+    }
+
+    MpmcQueue(const MpmcQueue &) = delete;
+    MpmcQueue &operator=(const MpmcQueue &) = delete;
+
+    /**
+     * 入队，队列已满时返回 false（v 保持不变）
+     */
+    bool push(T &&v) {
+        Cell *cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // 槽位空闲，尝试占有该位置
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                // 槽位仍被上一轮的元素占用：队列已满
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::move(v));
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队，队列为空时返回 false
+     */
+    bool pop(T &v) {
+        Cell *cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                // 槽位已写入，尝试占有该位置
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                // 槽位尚未写入：队列为空
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T *elem = reinterpret_cast<T *>(cell->storage);
+        v = std::move(*elem);
+        elem->~T();
+        // 标记为下一轮可写
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct alignas(CacheLineSize) Cell {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    alignas(CacheLineSize) std::atomic<size_t> enqueuePos_;
+    alignas(CacheLineSize) std::atomic<size_t> dequeuePos_;
+    alignas(CacheLineSize) std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+};
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef MPSCQUEUE_HPP_
+#define MPSCQUEUE_HPP_
+
+#include "cacheline.hpp"
+#include "poolalloc.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace lmc {
+
+/**
+ * MpscQueue - 无界多生产者单消费者无锁队列（Vyukov 链表队列）
+ *
+ * 特点：
+ * - push 是无等待的：一次原子交换取得位置，再以一次 release 存储链接到前一个节点，没有 CAS 重试
+ * - pop 只由一个消费者调用，不需要任何原子读改写，只读取队首节点的 next
+ * - 节点来自线程缓存的内存池（poolAllocate），稳态下不调用 malloc
+ * - 生产者写入的 tail 与消费者写入的 head 分别独占缓存行
+ *
+ * 约束：
+ * - 同一时刻只能有一个线程调用 pop()
+ * - 某个生产者已交换 tail 但尚未链接时，其后的元素对消费者暂不可见，pop() 返回 false；
+ *   调用者若由其他途径（例如计数）得知队列非空，应短暂自旋后重试
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node *stub = allocate();
+        head_ = stub;
+        tail_.store(stub, std::memory_order_relaxed);
+    }
+
+    ~MpscQueue() {
+        T v;
+        while (pop(v)) {}
+        poolDeallocate(head_, sizeof(Node));
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * 入队（任意线程）
+     */
+    void push(T &&v) {
+        Node *n = allocate();
+        new (n->storage) T(std::move(v));
+        Node *prev = tail_.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    /**
+     * 出队（仅消费者调用），队列为空（或队首元素尚未链接完成）时返回 false
+     */
+    bool pop(T &v) {
+        Node *next = head_->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        // next 成为新的哨兵节点：取走其中的元素，释放旧的哨兵节点
+        T *elem = reinterpret_cast<T *>(next->storage);
+        v = std::move(*elem);
+        elem->~T();
+        poolDeallocate(head_, sizeof(Node));
+        head_ = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static Node *allocate() {
+        Node *n = new (poolAllocate(sizeof(Node))) Node;
+        n->next.store(nullptr, std::memory_order_relaxed);
+        return n;
+    }
+
+    // 消费者写入
+    alignas(CacheLineSize) Node *head_;
+
+    // 生产者写入
+    alignas(CacheLineSize) std::atomic<Node *> tail_;
+};
+}
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef POOLALLOC_HPP_
+#define POOLALLOC_HPP_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * 小块内存池：任务对象与 promise 共享状态等生命周期很短的小对象使用
+ *
+ * 结构：
+ * - 按 2 的幂划分 ClassCount 个尺寸等级（16 ~ 2048 字节），更大的请求直接交给 ::operator new
+ * - 每个线程为每个等级维护一个空闲链表（线程缓存），分配与释放都只操作本线程的链表，不加锁
+ * - 线程缓存为空时从中心池一次取回一批（BatchSize 块），空闲块过多时一次归还一批；
+ *   中心池也没有空闲块时从 SlabSize 大小的内存块中切分
+ *
+ * 跨线程释放（提交者分配、后台线程释放）的块先进入释放线程的缓存，积累到一批后经中心池
+ * 回到分配方，每 BatchSize 次分配/释放才有一次加锁，稳态下不再调用全局的 malloc。
+ * 从内存块切分出的内存只在池内循环使用，不会归还给系统。
+ *
+ * 中心池按 NUMA 节点各有一个（最多 MaxNodes 个，超出的节点编号取模）：线程按 threadNode
+ * 选择中心池，绑定到某个节点的后台线程（Thread::setAffinity）只与本节点的中心池交换空闲块，
+ * 新内存块也由本节点的线程切分（首次写入），物理页通常分配在本节点。跨节点释放的块进入
+ * 释放方节点的中心池，因此这只是近似的节点本地化。
+ *
+ * 定义 LMC_DISABLE_POOL 时所有请求直接使用 ::operator new/delete（便于内存检查工具定位问题）。
+ */
+namespace pool {
+
+constexpr size_t MinBlock = 16;
+constexpr size_t ClassCount = 8;
+constexpr size_t MaxBlock = MinBlock << (ClassCount - 1);
+constexpr size_t BatchSize = 32;
+constexpr size_t SlabSize = 64 * 1024;
+constexpr size_t MaxNodes = 8;
+
+struct FreeBlock {
+    FreeBlock *next;
+};
+
+/**
+ * 尺寸对应的等级：满足 (MinBlock << c) >= n 的最小 c
+ */
+inline size_t classOf(size_t n) {
+    size_t c = 0;
+    size_t size = MinBlock;
+    while (size < n) {
+        size <<= 1;
+        ++c;
+    }
+    return c;
+}
+
+/**
+ * Central - 所有线程共享的中心池，以批为单位与线程缓存交换空闲块
+ */
+class Central {
+public:
+    struct Batch {
+        FreeBlock *head;
+        size_t count;
+    };
+
+    /**
+     * 取出一批空闲块（没有时切分新的内存块）
+     */
+    Batch take(size_t cls) {
+        std::lock_guard<std::mutex> lock(m);
+        auto &list = batches[cls];
+        if (list.empty())
+            carve(cls);
+        Batch b = list.back();
+        list.pop_back();
+        return b;
+    }
+
+    /**
+     * 归还一批空闲块（count 可以小于 BatchSize）
+     */
+    void give(size_t cls, FreeBlock *head, size_t count) {
+        std::lock_guard<std::mutex> lock(m);
+        batches[cls].push_back(Batch{head, count});
+    }
+
+private:
+    void carve(size_t cls) {
+        size_t size = MinBlock << cls;
+        size_t n = SlabSize / size;
+        char *slab = static_cast<char *>(::operator new(SlabSize));
+
+        for (size_t i = 0; i < n; i += BatchSize) {
+            size_t count = n - i < BatchSize ? n - i : BatchSize;
+            FreeBlock *head = nullptr;
+            for (size_t k = count; k-- > 0;) {
+                auto *b = reinterpret_cast<FreeBlock *>(slab + (i + k) * size);
+                b->next = head;
+                head = b;
+            }
+            batches[cls].push_back(Batch{head, count});
+        }
+    }
+
+    std::mutex m;
+    std::vector<Batch> batches[ClassCount];
+};
+
+/**
+ * 当前线程所在的 NUMA 节点，决定使用哪个中心池；默认 0，由 Thread 的后台线程按绑定结果设置
+ */
+inline thread_local unsigned threadNode = 0;
+
+/**
+ * 中心池在进程退出时有意不析构：静态对象析构之后仍可能有线程归还内存
+ */
+inline Central &central(unsigned node) {
+    static Central *c = new Central[MaxNodes];
+    return c[node % MaxNodes];
+}
+
+/**
+ * 当前线程所在节点的中心池
+ */
+inline Central &central() {
+    return central(threadNode);
+}
+
+/**
+ * 线程缓存已析构的标记（可平凡析构，线程退出的任意阶段都可以安全读取）
+ */
+inline thread_local bool cacheDestroyed = false;
+
+/**
+ * ThreadCache - 每个线程的空闲链表，线程退出时把剩余的空闲块全部归还中心池
+ */
+class ThreadCache {
+public:
+    ThreadCache() {
+        for (auto &l : lists)
+            l = List{nullptr, 0};
+    }
+
+    ~ThreadCache() {
+        for (size_t cls = 0; cls < ClassCount; ++cls)
+            if (lists[cls].head)
+                central().give(cls, lists[cls].head, lists[cls].count);
+        cacheDestroyed = true;
+    }
+
+    void *allocate(size_t cls) {
+        List &l = lists[cls];
+        if (!l.head) {
+            Central::Batch b = central().take(cls);
+            l.head = b.head;
+            l.count = b.count;
+        }
+        FreeBlock *b = l.head;
+        l.head = b->next;
+        --l.count;
+        return b;
+    }
+
+    void deallocate(void *p, size_t cls) {
+        List &l = lists[cls];
+        auto *b = static_cast<FreeBlock *>(p);
+        b->next = l.head;
+        l.head = b;
+
+        // 保留一批供本线程再次分配，多出的一批归还中心池
+        if (++l.count >= 2 * BatchSize) {
+            FreeBlock *tail = l.head;
+            for (size_t i = 1; i < BatchSize; ++i)
+                tail = tail->next;
+            FreeBlock *rest = tail->next;
+            tail->next = nullptr;
+            central().give(cls, l.head, BatchSize);
+            l.head = rest;
+            l.count -= BatchSize;
+        }
+    }
+
+private:
+    struct List {
+        FreeBlock *head;
+        size_t count;
+    };
+
+    List lists[ClassCount];
+};
+
+inline ThreadCache &threadCache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+}
+
+/**
+ * 从内存池分配 n 字节（对齐到 alignof(std::max_align_t)）
+ */
+inline void *poolAllocate(size_t n) {
+#ifndef LMC_DISABLE_POOL
+    if (n <= pool::MaxBlock) {
+        size_t cls = pool::classOf(n);
+        if (!pool::cacheDestroyed)
+            return pool::threadCache().allocate(cls);
+
+        // 线程缓存已析构（线程退出阶段）：直接与中心池交换单个块
+        pool::Central::Batch b = pool::central().take(cls);
+        if (b.count > 1)
+            pool::central().give(cls, b.head->next, b.count - 1);
+        return b.head;
+    }
+#endif
+    return ::operator new(n);
+}
+
+/**
+ * 归还 poolAllocate(n) 得到的内存，n 必须与分配时相同
+ */
+inline void poolDeallocate(void *p, size_t n) {
+#ifndef LMC_DISABLE_POOL
+    if (n <= pool::MaxBlock) {
+        size_t cls = pool::classOf(n);
+        if (!pool::cacheDestroyed) {
+            pool::threadCache().deallocate(p, cls);
+        } else {
+            auto *b = static_cast<pool::FreeBlock *>(p);
+            b->next = nullptr;
+            pool::central().give(cls, b, 1);
+        }
+        return;
+    }
+#endif
+    ::operator delete(p);
+}
+
+/**
+ * PoolAllocator - 基于 poolAllocate 的标准分配器
+ *
+ * 可用于 std::allocate_shared、std::promise(std::allocator_arg, ...) 等接受分配器的接口；
+ * 对齐要求超过 alignof(std::max_align_t) 的类型退化为 ::operator new。
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+    T *allocate(size_t n) {
+        if (alignof(T) > alignof(std::max_align_t))
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+        return static_cast<T *>(poolAllocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) noexcept {
+        if (alignof(T) > alignof(std::max_align_t)) {
+            ::operator delete(p, std::align_val_t(alignof(T)));
+            return;
+        }
+        poolDeallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &) const noexcept {
+        return false;
+    }
+};
+}
+
+#endif
@@ -1,32 +1,55 @@
 #ifndef SPINMUTEX_HPP_
 #define SPINMUTEX_HPP_
 
+#include "cacheline.hpp"
+#include "cpupause.hpp"
+
 #include <atomic>
+#include <thread>
 
 namespace lmc {
 
 /**
- * SpinMutex - 基于原子标志的自旋锁（轻量级）
+ * SpinMutex - 基于原子标志的自旋锁（TTAS + 指数退避）
  *
  * 特点：
  * - 适合短临界区并且对延迟敏感的场景
- * - 使用 compare_exchange_weak 原子操作进行尝试获取锁，失败则不断重试（繁忙等待）
- * - unlock() 将标志置为 false，允许其他线程获取锁
+ * - test-and-test-and-set：只在观察到锁空闲时才尝试一次 exchange，等待期间只读本地缓存的标志，
+ *   不会因为反复写入而占满缓存一致性带宽、拖慢持锁者
+ * - 每次观察到锁被占用后按 1, 2, 4 ... MaxBackoff 次 CPU pause 指数退避；退避达到上限后改为
+ *   std::this_thread::yield()，持锁线程被抢占时（线程数多于 CPU 核数）不会空转整个时间片
+ * - 加锁为 acquire、解锁为 release，而不是顺序一致
+ * - 不保证公平，需要公平性时使用 TicketMutex，高争用时使用 McsMutex
+ * - 独占一个缓存行：争用者反复写入标志，不能与其他数据（如被保护的数据或只读配置）共享缓存行
  */
-class SpinMutex {
+class alignas(CacheLineSize) SpinMutex {
 public:
+    static constexpr unsigned MaxBackoff = 64;
+
     SpinMutex() : flag_(false) {}
 
     inline void lock() {
-        bool expect = false;
-        // compare_exchange_weak 在失败时会修改 expect，所以每次循环需要重置 expect
-        while (!flag_.compare_exchange_weak(expect, true)) {
-            expect = false;
+        unsigned backoff = 1;
+        while (flag_.exchange(true, std::memory_order_acquire)) {
+            // 只读等待，直到锁看起来空闲再重新尝试
+            do {
+                if (backoff <= MaxBackoff) {
+                    for (unsigned i = 0; i < backoff; ++i)
+                        cpuPause();
+                    backoff <<= 1;
+                } else {
+                    std::this_thread::yield();
+                }
+            } while (flag_.load(std::memory_order_relaxed));
         }
     }
 
+    inline bool try_lock() {
+        return !flag_.load(std::memory_order_relaxed) && !flag_.exchange(true, std::memory_order_acquire);
+    }
+
     inline void unlock() {
-        flag_.store(false);
+        flag_.store(false, std::memory_order_release);
     }
 
 private:
@@ -34,4 +57,4 @@ private:
 };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,124 @@
+#ifndef SPSCQUEUE_HPP_
+#define SPSCQUEUE_HPP_
+
+#include "cacheline.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lmc {
+
+/**
+ * SpscQueue - 有界单生产者单消费者无等待环形队列
+ *
+ * 特点：
+ * - 容量在构造时确定（向上取整为 2 的幂），所有槽位预先分配，push/pop 不做任何内存分配
+ * - push/pop 都是无等待的：没有 CAS 与重试循环，只有一次 release 存储发布自己的位置
+ * - 生产者缓存最近一次读到的 head，消费者缓存最近一次读到的 tail，只有缓存值显示队列满/空时
+ *   才去读取对方的位置，稳态下两端几乎不访问对方写入的缓存行
+ * - 生产者、消费者各自的状态分别独占缓存行
+ *
+ * 约束：
+ * - 同一时刻只能有一个线程调用 push()，一个线程调用 pop()（可以是不同的线程）
+ * - 队列满时 push() 返回 false，队列空时 pop() 返回 false，由调用者决定重试策略
+ */
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        cachedHead_ = 0;
+        cachedTail_ = 0;
+    }
+
+    ~SpscQueue() {
+        T v;
+        while (pop(v)) {}
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * 入队（仅生产者调用），队列已满时返回 false（v 保持不变）
+     */
+    bool push(T &&v) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_)
+                return false;
+        }
+
+        new (slots_[tail & mask_].storage) T(std::move(v));
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队（仅消费者调用），队列为空时返回 false
+     */
+    bool pop(T &v) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_)
+                return false;
+        }
+
+        T *elem = reinterpret_cast<T *>(slots_[head & mask_].storage);
+        v = std::move(*elem);
+        elem->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 是否为空（任意线程均可调用，并发情况下为近似值）
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 近似元素个数（任意线程均可调用）
+     */
+    size_t size() const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // 构造之后只读
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    // 生产者写入
+    alignas(CacheLineSize) std::atomic<size_t> tail_;
+    size_t cachedHead_;                 // 生产者看到的 head（可能滞后，只会低估可用空间）
+
+    // 消费者写入
+    alignas(CacheLineSize) std::atomic<size_t> head_;
+    size_t cachedTail_;                 // 消费者看到的 tail（可能滞后，只会低估可取元素）
+};
+}
+
+#endif
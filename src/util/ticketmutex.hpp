@@ -0,0 +1,70 @@
+#ifndef TICKETMUTEX_HPP_
+#define TICKETMUTEX_HPP_
+
+#include "cacheline.hpp"
+#include "cpupause.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace lmc {
+
+/**
+ * TicketMutex - 排号自旋锁（公平，先到先得）
+ *
+ * 特点：
+ * - lock() 取一个号（next_ 自增），等待 serving_ 叫到自己的号；unlock() 叫下一个号
+ * - 严格 FIFO，不会有线程被饿死；适合争用中等、需要公平性的场景
+ * - 等待时按与当前叫号的距离成比例退避：排在越后面等待越久，减少对 serving_ 的无效读取；
+ *   累计自旋超过 SpinBudget 次 pause 后改为 yield（持锁或即将持锁的线程可能已被抢占，
+ *   线程数多于 CPU 核数时 FIFO 交接必须等它重新被调度）
+ * - 所有等待者都读同一个 serving_，每次解锁都会使所有等待者的缓存行失效，
+ *   等待者很多时应使用 McsMutex
+ * - next_ 由加锁者写入、serving_ 由解锁者写入，分属不同缓存行
+ */
+class alignas(CacheLineSize) TicketMutex {
+public:
+    static constexpr unsigned PausePerWaiter = 8;
+    static constexpr unsigned SpinBudget = 256;
+
+    TicketMutex() : next_(0), serving_(0) {}
+
+    inline void lock() {
+        uint32_t my = next_.fetch_add(1, std::memory_order_relaxed);
+        unsigned spent = 0;
+        for (;;) {
+            uint32_t cur = serving_.load(std::memory_order_acquire);
+            if (cur == my)
+                return;
+
+            if (spent < SpinBudget) {
+                uint32_t pauses = (my - cur) * PausePerWaiter;
+                for (uint32_t i = 0; i < pauses; ++i)
+                    cpuPause();
+                spent += pauses;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    inline bool try_lock() {
+        uint32_t cur = serving_.load(std::memory_order_relaxed);
+        uint32_t expect = cur;
+        return next_.compare_exchange_strong(expect, cur + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    inline void unlock() {
+        // 只有持锁者写 serving_，普通的读-加-写即可
+        serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::atomic<uint32_t> next_;
+    alignas(CacheLineSize) std::atomic<uint32_t> serving_;
+};
+}
+
+#endif
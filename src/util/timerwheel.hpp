@@ -0,0 +1,246 @@
+#ifndef TIMERWHEEL_HPP_
+#define TIMERWHEEL_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lmc {
+
+/**
+ * TimerWheelNode - 定时轮中的侵入式节点
+ *
+ * 使用者从该类派生，并在插入前设置 expiry（到期 tick）。
+ * 节点在定时轮中时 linked() 为 true，此时只能由定时轮修改 prev/next。
+ */
+struct TimerWheelNode {
+    TimerWheelNode *prev = nullptr;
+    TimerWheelNode *next = nullptr;
+    uint64_t expiry = 0;
+    unsigned char level = 0;
+    unsigned char slot = 0;
+
+    bool linked() const {
+        return next != nullptr;
+    }
+};
+
+/**
+ * TimerWheel - 分层时间轮（非线程安全，由调用者加锁）
+ *
+ * 结构：
+ * - 共 Levels 层，每层 Slots(64) 个槽位；第 L 层每个槽位覆盖 64^L 个 tick，
+ *   四层合计覆盖 2^24 个 tick（tick 为 1ms 时约 4.6 小时），更远的定时器在最高层循环等待
+ * - 每个槽位是一个带哨兵的双向循环链表，插入与删除都是 O(1)
+ * - 每层维护一个 64 位占用位图，可在 O(层数) 时间内求出下一个需要处理的 tick，
+ *   推进时直接跳过空闲的 tick，而不是逐个 tick 检查
+ *
+ * 推进到某个 tick 时，若低层刚好转完一圈，则把高层对应槽位中的节点重新插入（降级到更低层），
+ * 最后第 0 层当前槽位中的节点即为到期节点。
+ */
+class TimerWheel {
+public:
+    static constexpr unsigned LevelBits = 6;
+    static constexpr unsigned Levels = 4;
+    static constexpr unsigned Slots = 1u << LevelBits;
+
+    explicit TimerWheel(uint64_t now = 0) : current_(now), count_(0) {
+        for (unsigned l = 0; l < Levels; ++l) {
+            bitmap_[l] = 0;
+            for (unsigned s = 0; s < Slots; ++s) {
+                slots_[l][s].prev = &slots_[l][s];
+                slots_[l][s].next = &slots_[l][s];
+            }
+        }
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /**
+     * 按节点的 expiry 插入；expiry 不晚于当前 tick 时不插入并返回 false（调用者应立即处理）
+     */
+    bool insert(TimerWheelNode *n) {
+        if (n->expiry <= current_)
+            return false;
+
+        uint64_t delta = n->expiry - current_;
+        unsigned level = 0;
+        while (level + 1 < Levels && delta >= (uint64_t(1) << (LevelBits * (level + 1))))
+            ++level;
+
+        unsigned slot = static_cast<unsigned>((n->expiry >> (LevelBits * level)) & (Slots - 1));
+        TimerWheelNode *head = &slots_[level][slot];
+        n->level = static_cast<unsigned char>(level);
+        n->slot = static_cast<unsigned char>(slot);
+        n->prev = head->prev;
+        n->next = head;
+        head->prev->next = n;
+        head->prev = n;
+        bitmap_[level] |= uint64_t(1) << slot;
+        ++count_;
+        return true;
+    }
+
+    /**
+     * 从定时轮中移除节点（必须处于 linked 状态）
+     */
+    void remove(TimerWheelNode *n) {
+        n->prev->next = n->next;
+        n->next->prev = n->prev;
+        TimerWheelNode *head = &slots_[n->level][n->slot];
+        if (head->next == head)
+            bitmap_[n->level] &= ~(uint64_t(1) << n->slot);
+        n->prev = n->next = nullptr;
+        --count_;
+    }
+
+    /**
+     * 推进到 tick to，对每个到期节点调用 onExpire(node)；节点在回调前已从定时轮移除
+     */
+    template <typename F>
+    void advance(uint64_t to, F &&onExpire) {
+        while (current_ < to) {
+            uint64_t next = nextEvent();
+            if (next > to) {
+                current_ = to;
+                return;
+            }
+            current_ = next;
+
+            // 自顶向下降级：高层节点可能落入同一时刻将要处理的低层槽位
+            unsigned top = 0;
+            for (unsigned l = 1; l < Levels; ++l) {
+                if ((current_ & ((uint64_t(1) << (LevelBits * l)) - 1)) != 0)
+                    break;
+                top = l;
+            }
+            for (unsigned l = top; l >= 1; --l)
+                cascade(l, onExpire);
+
+            expireSlot(static_cast<unsigned>(current_ & (Slots - 1)), onExpire);
+        }
+    }
+
+    /**
+     * 移除所有节点，对每个节点调用 onRemove(node)
+     */
+    template <typename F>
+    void drain(F &&onRemove) {
+        for (unsigned l = 0; l < Levels; ++l) {
+            for (unsigned s = 0; s < Slots; ++s) {
+                TimerWheelNode *n = detach(l, s);
+                while (n) {
+                    TimerWheelNode *next = n->next;
+                    n->prev = n->next = nullptr;
+                    --count_;
+                    onRemove(n);
+                    n = next;
+                }
+            }
+        }
+    }
+
+    /**
+     * 下一个需要处理的 tick（到期或降级），定时轮为空时返回 UINT64_MAX
+     */
+    uint64_t nextEvent() const {
+        uint64_t best = UINT64_MAX;
+        if (count_ == 0)
+            return best;
+
+        for (unsigned l = 0; l < Levels; ++l) {
+            if (bitmap_[l] == 0)
+                continue;
+            unsigned shift = LevelBits * l;
+            unsigned cur = static_cast<unsigned>((current_ >> shift) & (Slots - 1));
+            unsigned dist = nearestDistance(bitmap_[l], cur);
+            uint64_t t = ((current_ >> shift) + dist) << shift;
+            if (t < best)
+                best = t;
+        }
+        return best;
+    }
+
+    uint64_t current() const {
+        return current_;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+private:
+    /**
+     * 位图中距 cur 最近的（严格在其之后，循环意义下）被占用槽位的距离，范围 [1, 64]
+     */
+    static unsigned nearestDistance(uint64_t bits, unsigned cur) {
+        unsigned start = (cur + 1) & (Slots - 1);
+        uint64_t rotated = start == 0 ? bits : ((bits >> start) | (bits << (Slots - start)));
+        unsigned slot = (start + countTrailingZeros(rotated)) & (Slots - 1);
+        unsigned dist = (slot - cur) & (Slots - 1);
+        return dist == 0 ? Slots : dist;
+    }
+
+    static unsigned countTrailingZeros(uint64_t x) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, x);
+        return static_cast<unsigned>(idx);
+#else
+        return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+    }
+
+    /**
+     * 取出整个槽位链表（槽位随即变为空），返回第一个节点（链表以 nullptr 结尾）
+     */
+    TimerWheelNode *detach(unsigned level, unsigned slot) {
+        TimerWheelNode *head = &slots_[level][slot];
+        if (head->next == head)
+            return nullptr;
+
+        TimerWheelNode *first = head->next;
+        head->prev->next = nullptr;
+        head->prev = head->next = head;
+        bitmap_[level] &= ~(uint64_t(1) << slot);
+        return first;
+    }
+
+    template <typename F>
+    void cascade(unsigned level, F &onExpire) {
+        unsigned slot = static_cast<unsigned>((current_ >> (LevelBits * level)) & (Slots - 1));
+        TimerWheelNode *n = detach(level, slot);
+        while (n) {
+            TimerWheelNode *next = n->next;
+            n->prev = n->next = nullptr;
+            --count_;
+            if (!insert(n))
+                onExpire(n);
+            n = next;
+        }
+    }
+
+    template <typename F>
+    void expireSlot(unsigned slot, F &onExpire) {
+        TimerWheelNode *n = detach(0, slot);
+        while (n) {
+            TimerWheelNode *next = n->next;
+            n->prev = n->next = nullptr;
+            --count_;
+            onExpire(n);
+            n = next;
+        }
+    }
+
+    TimerWheelNode slots_[Levels][Slots]; // 各槽位链表的哨兵
+    uint64_t bitmap_[Levels];             // 各层槽位占用位图
+    uint64_t current_;                    // 当前 tick（已处理到的时刻）
+    size_t count_;                        // 节点总数
+};
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef WSDEQUE_HPP_
+#define WSDEQUE_HPP_
+
+#include "cacheline.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace lmc {
+
+/**
+ * WorkStealingDeque - Chase-Lev 工作窃取双端队列
+ *
+ * 特点：
+ * - 拥有者线程在底部（bottom）执行 push()/pop()，后进先出，有利于缓存局部性
+ * - 其他线程在顶部（top）执行 steal()，先进先出，窃取最早放入的（通常也是最大的）任务
+ * - 拥有者的 push()/pop() 在无竞争时不需要任何 CAS，只有与窃取者争夺最后一个元素时才发生 CAS
+ * - 容量不足时由拥有者扩容为两倍；旧数组保留到析构时释放，保证并发窃取者读取旧数组是安全的
+ *
+ * 约束：
+ * - T 必须是可平凡复制的类型（通常为指针），元素以原子方式读写
+ * - push()/pop() 只能由拥有者线程调用；steal() 可被任意线程调用
+ *
+ * 内存序参考 Lê 等人《Correct and Efficient Work-Stealing for Weak Memory Models》，
+ * 其中的独立 fence 改写为 seq_cst 原子操作，便于 ThreadSanitizer 等工具理解。
+ */
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque 的元素必须可平凡复制");
+
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) : top_(0), bottom_(0) {
+        int64_t cap = 1;
+        while (cap < capacity)
+            cap <<= 1;
+        arrays_.emplace_back(new Array(cap));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    /**
+     * 拥有者线程：将元素压入底部
+     */
+    void push(T x) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array *a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1)
+            a = grow(a, t, b);
+        a->put(b, x);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    /**
+     * 拥有者线程：从底部弹出元素，队列为空或最后一个元素被窃取时返回 false
+     */
+    bool pop(T &x) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array *a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+
+        if (t > b) {
+            // 队列为空，恢复 bottom
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        x = a->get(b);
+        if (t == b) {
+            // 只剩最后一个元素，需要与窃取者竞争
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * 任意线程：从顶部窃取元素，队列为空或与其他线程竞争失败时返回 false
+     */
+    bool steal(T &x) {
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_seq_cst);
+        if (t >= b)
+            return false;
+
+        Array *a = array_.load(std::memory_order_acquire);
+        x = a->get(t);
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+
+    /**
+     * 近似判断是否为空（并发情况下仅作为提示）
+     */
+    bool empty() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+    /**
+     * 近似元素个数（并发情况下仅作为提示）
+     */
+    size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t cap)
+            : capacity(cap), mask(cap - 1), buffer(new std::atomic<T>[static_cast<size_t>(cap)]) {}
+
+        T get(int64_t i) const {
+            return buffer[static_cast<size_t>(i & mask)].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t i, T x) {
+            buffer[static_cast<size_t>(i & mask)].store(x, std::memory_order_relaxed);
+        }
+
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> buffer;
+    };
+
+    /**
+     * 扩容：拷贝 [t, b) 区间到两倍大小的新数组，旧数组留在 arrays_ 中直到析构
+     */
+    Array *grow(Array *a, int64_t t, int64_t b) {
+        Array *na = new Array(a->capacity * 2);
+        for (int64_t i = t; i < b; ++i)
+            na->put(i, a->get(i));
+        arrays_.emplace_back(na);
+        array_.store(na, std::memory_order_release);
+        return na;
+    }
+
+    // top_ 由窃取者写入，bottom_ 与数组由拥有者写入，分别独占缓存行
+    alignas(CacheLineSize) std::atomic<int64_t> top_;
+    alignas(CacheLineSize) std::atomic<int64_t> bottom_;
+    std::atomic<Array *> array_;
+    std::vector<std::unique_ptr<Array>> arrays_; // 仅拥有者线程修改
+};
+}
+
+#endif